@@ -0,0 +1,279 @@
+﻿// bench.cpp : times the maze phases on their own over a grid of sizes and seeds.
+//
+
+#include "maze.h"
+#include <sstream>
+
+MAZE_COUNT_ALLOCATIONS
+
+struct BenchOptions {
+	std::vector<unsigned> sizes = { 16, 32, 100, 316, 1000, 3162, 10000 }; // square mazes
+	unsigned seeds = 3;
+	std::uint64_t firstSeed = 1;
+	double minSeconds = 0.2; // a phase is repeated until it ran at least this long
+	unsigned threads = 0; // pool size of generateAreaParallel, 0 for all cores
+	std::string outputFile; // stdout when empty
+	std::string svgDir = std::filesystem::temp_directory_path().string();
+};
+
+void printUsage(const char * program)
+{
+	std::cerr << "usage: " << program << " [options]\n"
+		<< "  --sizes A,B,...   widths of the square mazes (16,32,100,316,1000,3162,10000)\n"
+		<< "  --seeds N         seeds per size (3)\n"
+		<< "  --seed S          first seed (1)\n"
+		<< "  --min-time T      seconds every phase is repeated for (0.2)\n"
+		<< "  --threads N       generateAreaParallel threads, 0 for all cores (0)\n"
+		<< "  --output FILE     JSON results, stdout when omitted\n"
+		<< "  --svg-dir DIR     directory for the printMazeSVG files (the temp directory)\n";
+}
+
+bool parseBenchOptions(const int argc, char * argv[], BenchOptions & options)
+{
+	for (int i = 1; i < argc; ++i) {
+		const std::string name = argv[i];
+		if (i + 1 >= argc) {
+			std::cerr << "missing value for " << name << std::endl;
+			return false;
+		}
+		const std::string value = argv[++i];
+
+		try {
+			if (name == "--sizes") {
+				options.sizes.clear();
+				std::size_t begin = 0;
+				while (begin <= value.size()) {
+					const std::size_t end = std::min(value.find(',', begin), value.size());
+					const unsigned size = unsigned(std::stoul(value.substr(begin, end - begin)));
+					if (size == 0) {
+						throw std::invalid_argument(value);
+					}
+					options.sizes.push_back(size);
+					begin = end + 1;
+				}
+			}
+			else if (name == "--seeds") {
+				options.seeds = unsigned(std::stoul(value));
+			}
+			else if (name == "--seed") {
+				options.firstSeed = std::stoull(value);
+			}
+			else if (name == "--min-time") {
+				options.minSeconds = std::stod(value);
+			}
+			else if (name == "--threads") {
+				options.threads = unsigned(std::stoul(value));
+			}
+			else if (name == "--output") {
+				options.outputFile = value;
+			}
+			else if (name == "--svg-dir") {
+				options.svgDir = value;
+			}
+			else {
+				std::cerr << "unknown option " << name << std::endl;
+				return false;
+			}
+		}
+		catch (const std::exception &) {
+			std::cerr << "invalid value for " << name << ": " << value << std::endl;
+			return false;
+		}
+	}
+	return options.seeds != 0;
+}
+
+// One phase on one maze. Cells are the cells the phase works on, bytes the bytes it produces
+// or scans: wall bits, distance maps or the SVG file.
+struct BenchResult {
+	const char * phase;
+	unsigned width;
+	unsigned height;
+	std::uint64_t seed;
+	unsigned iterations;
+	double seconds;
+	std::uint64_t cells;
+	std::uint64_t bytes;
+	std::string counters; // JSON of the counters collected while the phase ran
+};
+
+// Repeats run until minSeconds have passed, setup is called before every run and is not timed.
+// The counters are reset before the first setup, so they include setup allocations.
+template <typename Setup, typename Run>
+BenchResult measure(const BenchOptions & options, const char * phase, const unsigned width, const unsigned height, const std::uint64_t seed, Setup setup, Run run)
+{
+	mazeCounters.reset();
+
+	BenchResult result = { phase, width, height, seed, 0, 0.0, 0, 0, "" };
+	do {
+		setup();
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		run(result);
+		result.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		++result.iterations;
+	} while (result.seconds < options.minSeconds);
+
+	std::ostringstream counters;
+	mazeCounters.writeJson(counters, "      ");
+	result.counters = counters.str();
+	return result;
+}
+
+void benchMaze(const BenchOptions & options, const unsigned size, const std::uint64_t seed, std::vector<BenchResult> & results)
+{
+	const std::uint64_t cells = std::uint64_t(size) * size;
+	const std::uint64_t mapBytes = cells * sizeof(DistanceMap::unreachable());
+
+	std::unique_ptr<Maze> maze;
+	std::mt19937 rng;
+	results.push_back(measure(options, "generateArea", size, size, seed, [&] {
+		maze.reset(new Maze(size, size));
+		rng = seededRandom(seed);
+	}, [&](BenchResult & result) {
+		generateArea(*maze, rng, 0, 0, size, size);
+		result.cells = cells;
+		result.bytes = (maze->horizontalWalls.wordCount() + maze->verticalWalls.wordCount()) * 8;
+	}));
+
+	{
+		TaskPool pool(options.threads);
+		std::unique_ptr<Maze> parallelMaze;
+		results.push_back(measure(options, "generateAreaParallel", size, size, seed, [&] {
+			parallelMaze.reset(new Maze(size, size));
+		}, [&](BenchResult & result) {
+			generateAreaParallel(*parallelMaze, pool, seed);
+			result.cells = cells;
+			result.bytes = (parallelMaze->horizontalWalls.wordCount() + parallelMaze->verticalWalls.wordCount()) * 8;
+		}));
+	}
+
+	BfsWorkspace workspace;
+	placeEntryExit(*maze, rng, workspace);
+	maze->visualizedDMap = DistanceMap(); // keeps the memory of the largest sizes down
+
+	DistanceMap entryMap;
+	results.push_back(measure(options, "generateDistanceMap", size, size, seed, [] {}, [&](BenchResult & result) {
+		entryMap = generateDistanceMap(*maze, maze->entryNode);
+		result.cells = cells;
+		result.bytes = mapBytes;
+	}));
+
+	// the bitboard solver has to give the distances it is timed against
+	BitboardSolver solver(*maze);
+	DistanceMap bitboardMap;
+	results.push_back(measure(options, "BitboardSolver::solve", size, size, seed, [] {}, [&](BenchResult & result) {
+		solver.solve(&maze->entryNode, &maze->entryNode + 1, &bitboardMap);
+		result.cells = cells;
+		result.bytes = mapBytes;
+	}));
+	if (bitboardMap.cells != entryMap.cells) {
+		throw std::runtime_error("bitboard distances differ from generateDistanceMap");
+	}
+	bitboardMap = DistanceMap();
+
+	// scoring without a distance map, the farthest border cells come from the last frontiers
+	std::vector<unsigned> bitboardMaximums;
+	results.push_back(measure(options, "BitboardSolver::maximumsAtEdge", size, size, seed, [] {}, [&](BenchResult & result) {
+		solver.solve(maze->entryNode);
+		bitboardMaximums = solver.maximumsAtEdge();
+		result.cells = cells;
+		result.bytes = 0;
+	}));
+	if (bitboardMaximums != searchMaximumsAtEdge(*maze, entryMap)) {
+		throw std::runtime_error("bitboard border maximums differ from searchMaximumsAtEdge");
+	}
+	solver = BitboardSolver();
+
+	DistanceMap minimum;
+	{
+		const DistanceMap exitMap = generateDistanceMap(*maze, maze->exitNode);
+		results.push_back(measure(options, "minMap", size, size, seed, [] {}, [&](BenchResult & result) {
+			minimum = minMap(*maze, entryMap, exitMap);
+			result.cells = cells;
+			result.bytes = mapBytes;
+		}));
+	}
+
+	std::vector<Node> maximums;
+	results.push_back(measure(options, "searchMaximums", size, size, seed, [] {}, [&](BenchResult & result) {
+		maximums = searchMaximums(minimum);
+		result.cells = cells;
+		result.bytes = mapBytes;
+	}));
+
+	std::vector<unsigned> edgeMaximums;
+	results.push_back(measure(options, "searchMaximumsAtEdge", size, size, seed, [] {}, [&](BenchResult & result) {
+		edgeMaximums = searchMaximumsAtEdge(*maze, entryMap);
+		result.cells = std::uint64_t(size) * 4;
+		result.bytes = result.cells * sizeof(DistanceMap::unreachable());
+	}));
+
+	minimum = DistanceMap();
+	entryMap = DistanceMap();
+
+	const std::string svgName = (std::filesystem::path(options.svgDir) / ("maze_bench_" + std::to_string(size) + ".svg")).string();
+	results.push_back(measure(options, "printMazeSVG", size, size, seed, [] {}, [&](BenchResult & result) {
+		printMazeSVG(*maze, svgName, DistanceLabels::None);
+		result.cells = cells;
+		result.bytes = std::filesystem::file_size(svgName);
+	}));
+	std::filesystem::remove(svgName);
+}
+
+void writeResults(std::ostream & out, const std::vector<BenchResult> & results)
+{
+	out << "{\n  \"results\": [";
+	for (std::size_t i = 0; i < results.size(); ++i) {
+		const BenchResult & result = results[i];
+		const double perIteration = result.seconds / result.iterations;
+		out << (i == 0 ? "\n" : ",\n")
+			<< "    {\n"
+			<< "      \"phase\": \"" << result.phase << "\",\n"
+			<< "      \"width\": " << result.width << ",\n"
+			<< "      \"height\": " << result.height << ",\n"
+			<< "      \"seed\": " << result.seed << ",\n"
+			<< "      \"iterations\": " << result.iterations << ",\n"
+			<< "      \"seconds\": " << result.seconds << ",\n"
+			<< "      \"cellsPerSecond\": " << result.cells / perIteration << ",\n"
+			<< "      \"bytesPerSecond\": " << result.bytes / perIteration << ",\n"
+			<< "      \"counters\": " << result.counters << "\n"
+			<< "    }";
+	}
+	out << "\n  ]\n}\n";
+}
+
+int main(int argc, char * argv[])
+{
+	BenchOptions options;
+	if (!parseBenchOptions(argc, argv, options)) {
+		printUsage(argv[0]);
+		return 1;
+	}
+
+	std::vector<BenchResult> results;
+	try {
+		for (const unsigned size : options.sizes) {
+			for (unsigned i = 0; i < options.seeds; ++i) {
+				std::cerr << size << "x" << size << " seed " << options.firstSeed + i << std::endl;
+				benchMaze(options, size, options.firstSeed + i, results);
+			}
+		}
+	}
+	catch (const std::exception & e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+
+	if (options.outputFile.empty()) {
+		writeResults(std::cout, results);
+	}
+	else {
+		std::ofstream f(options.outputFile);
+		writeResults(f, results);
+		if (!f) {
+			std::cerr << "cannot write " << options.outputFile << std::endl;
+			return 1;
+		}
+	}
+	return 0;
+}
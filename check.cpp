@@ -0,0 +1,441 @@
+﻿// check.cpp : compares the alternative algorithms against the straightforward ones.
+// Run by ctest, exits with 1 and names the check when a result differs.
+//
+
+#include "maze.h"
+#include <cstddef>
+
+bool sameNodes(const std::vector<Node> & a, const std::vector<Node> & b)
+{
+	return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](const Node & x, const Node & y) { return x.row == y.row && x.col == y.col; });
+}
+
+// random inner walls, so the passages have loops and unreachable regions
+Maze randomWalls(const unsigned width, const unsigned height, std::mt19937 & rng, const double openShare)
+{
+	Maze maze(width, height);
+	std::bernoulli_distribution open(openShare);
+	for (unsigned row = 0; row < height; ++row) {
+		for (unsigned col = 0; col < width; ++col) {
+			if (row > 0 && open(rng)) {
+				maze.setHorizontalWall(row, col, false);
+			}
+			if (col > 0 && open(rng)) {
+				maze.setVerticalWall(row, col, false);
+			}
+		}
+	}
+	return maze;
+}
+
+// bitboard layers against the queue search, on generated mazes and on mazes with loops and
+// disconnected regions, with one and several sources
+bool checkBitboardSolver()
+{
+	std::mt19937 rng = seededRandom(3);
+	BfsWorkspace workspace;
+	BitboardSolver solver;
+	DistanceMap expected;
+	DistanceMap actual;
+
+	for (unsigned i = 0; i < 400; ++i) {
+		const unsigned width = 1 + randomIndex(rng, i < 300 ? 80 : 700);
+		const unsigned height = 1 + randomIndex(rng, 80);
+		Maze maze = randomWalls(width, height, rng, i % 2 == 0 ? 0.0 : 0.45);
+		if (i % 2 == 0) {
+			generateArea(maze, rng, 0, 0, width, height);
+		}
+
+		std::vector<Node> sources(1 + i % 3);
+		for (Node & source : sources) {
+			source = Node(randomIndex(rng, height), randomIndex(rng, width));
+		}
+
+		workspace.run(maze, sources.data(), sources.data() + sources.size(), expected);
+		solver.load(maze);
+		solver.solve(sources.data(), sources.data() + sources.size(), &actual);
+
+		if (actual.cells != expected.cells || !sameNodes(solver.maximums(), searchMaximums(expected)) || solver.maximumsAtEdge() != searchMaximumsAtEdge(maze, expected)) {
+			std::cerr << "bitboard solver differs from the queue search on a " << width << "x" << height << " maze" << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+bool sameWalls(const Maze & a, const Maze & b)
+{
+	return std::equal(a.horizontalWalls.data(), a.horizontalWalls.data() + a.horizontalWalls.wordCount(), b.horizontalWalls.data())
+		&& std::equal(a.verticalWalls.data(), a.verticalWalls.data() + a.verticalWalls.wordCount(), b.verticalWalls.data());
+}
+
+// parallel generation connects every cell and gives the same walls for every number of threads
+bool checkParallelGeneration()
+{
+	const unsigned sizes[][2] = { { 1, 1 }, { 64, 64 }, { 300, 200 }, { 257, 513 }, { 1000, 3 } };
+	BfsWorkspace workspace;
+	DistanceMap map;
+
+	for (const auto & size : sizes) {
+		for (std::uint64_t seed = 1; seed <= 3; ++seed) {
+			Maze reference(size[0], size[1]);
+			{
+				TaskPool pool(1);
+				generateAreaParallel(reference, pool, seed, 1024);
+			}
+
+			workspace.run(reference, Node(0, 0), map);
+			if (std::count(map.cells.begin(), map.cells.end(), DistanceMap::unreachable()) != 0) {
+				std::cerr << "parallel generation of " << size[0] << "x" << size[1] << " left unreachable cells" << std::endl;
+				return false;
+			}
+
+			for (const unsigned threads : { 2u, 8u }) {
+				Maze maze(size[0], size[1]);
+				TaskPool pool(threads);
+				generateAreaParallel(maze, pool, seed, 1024);
+				if (!sameWalls(maze, reference)) {
+					std::cerr << "parallel generation of " << size[0] << "x" << size[1] << " differs with " << threads << " threads" << std::endl;
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+// copies the rows of a streamed maze into a Maze, the entry and exit stay closed
+class MazeRowCopy : public RowSink {
+public:
+	void begin(const unsigned width, const unsigned height, unsigned, unsigned) override
+	{
+		maze.reset(new Maze(width, height));
+	}
+
+	void row(const unsigned row, const MazeRow & walls) override
+	{
+		for (unsigned col = 0; col < maze->width; ++col) {
+			if (col > 0) {
+				maze->setVerticalWall(row, col, walls.hasLeftWall(col));
+			}
+			if (row + 1 < maze->height) {
+				maze->setHorizontalWall(row + 1, col, walls.hasBottomWall(col));
+			}
+		}
+	}
+
+	void end() override {}
+
+	std::unique_ptr<Maze> maze;
+};
+
+// the tree pass against a search from every border cell, on perfect mazes from Eller's algorithm,
+// and the longest placement on generated mazes
+bool checkLongestPath()
+{
+	std::mt19937 rng = seededRandom(7);
+	BfsWorkspace workspace;
+	DistanceMap map;
+
+	for (unsigned i = 0; i < 200; ++i) {
+		const unsigned width = 1 + randomIndex(rng, i < 20 ? 3 : 40);
+		const unsigned height = 1 + randomIndex(rng, i < 20 ? 3 : 40);
+		MazeRowCopy copy;
+		generateStreaming(width, height, rng, copy);
+		const Maze & maze = *copy.maze;
+
+		EdgePath path;
+		if (!findLongestEdgePath(MazeView(maze), path)) {
+			std::cerr << "a perfect " << width << "x" << height << " maze was not taken for a tree" << std::endl;
+			return false;
+		}
+
+		unsigned longest = 0;
+		unsigned pathLength = DistanceMap::unreachable();
+		for (unsigned selection = 0; selection < width * 2 + height * 2; ++selection) {
+			const Node start = edgeCell(maze, selection);
+			workspace.run(maze, start, map);
+			for (unsigned other = 0; other < width * 2 + height * 2; ++other) {
+				const Node end = edgeCell(maze, other);
+				longest = std::max(longest, unsigned(map[end.row][end.col]));
+			}
+			if (start.row == path.first.row && start.col == path.first.col) {
+				pathLength = map[path.second.row][path.second.col];
+			}
+		}
+
+		if (path.length != longest || pathLength != longest) {
+			std::cerr << "longest border path of a " << width << "x" << height << " maze is " << longest << ", the tree pass gave " << path.length << std::endl;
+			return false;
+		}
+	}
+
+	// Longest placement on generated mazes with loops, with both search backends
+	BitboardSolver solver;
+	for (unsigned i = 0; i < 100; ++i) {
+		const unsigned width = 16 + randomIndex(rng, 17);
+		const unsigned height = 16 + randomIndex(rng, 17);
+		const std::uint64_t seed = rng();
+		Maze queueMaze(width, height);
+		Maze bitboardMaze(width, height);
+		std::mt19937 queueRng = seededRandom(seed);
+		std::mt19937 bitboardRng = seededRandom(seed);
+		generateArea(queueMaze, queueRng, 0, 0, width, height);
+		generateArea(bitboardMaze, bitboardRng, 0, 0, width, height);
+		placeEntryExit(queueMaze, queueRng, workspace, Placement::Longest);
+		placeEntryExit(bitboardMaze, bitboardRng, solver, Placement::Longest);
+
+		unsigned longest = 0;
+		for (unsigned selection = 0; selection < width * 2 + height * 2; ++selection) {
+			workspace.run(queueMaze, edgeCell(queueMaze, selection), map);
+			for (unsigned other = 0; other < width * 2 + height * 2; ++other) {
+				const Node end = edgeCell(queueMaze, other);
+				if (map[end.row][end.col] != DistanceMap::unreachable()) {
+					longest = std::max(longest, unsigned(map[end.row][end.col]));
+				}
+			}
+		}
+
+		for (const Maze * maze : { &queueMaze, &bitboardMaze }) {
+			workspace.run(*maze, maze->entryNode, map);
+			if (map[maze->exitNode.row][maze->exitNode.col] != longest) {
+				std::cerr << "longest placement on a " << width << "x" << height << " maze with loops is " << map[maze->exitNode.row][maze->exitNode.col]
+					<< " long instead of " << longest << (maze == &bitboardMaze ? " with the bitboard solver" : "") << std::endl;
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+// a copy of a saved file with value written over the field at offset
+std::string patchedMazeFile(const std::string & fileName, const std::size_t offset, const std::uint32_t value)
+{
+	std::ifstream in(fileName, std::ios::binary);
+	std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+	std::memcpy(&bytes[offset], &value, sizeof(value));
+
+	const std::string patchedName = fileName + ".patched";
+	std::ofstream out(patchedName, std::ios::binary);
+	out.write(bytes.data(), bytes.size());
+	return patchedName;
+}
+
+bool loadFails(const std::string & fileName)
+{
+	try {
+		const MappedMaze maze(fileName);
+	}
+	catch (const std::runtime_error &) {
+		return true;
+	}
+	return false;
+}
+
+// maze files round trip, headers with nodes or sizes outside of the file are rejected
+bool checkMazeFiles()
+{
+	std::mt19937 rng = seededRandom(5);
+	BfsWorkspace workspace;
+	const Maze maze = generateMaze(37, 21, rng, workspace);
+	const std::string fileName = (std::filesystem::temp_directory_path() / "maze_check.maze").string();
+	saveMaze(maze, fileName, true);
+
+	bool passed = true;
+	{
+		const MappedMaze loaded(fileName);
+		passed = loaded.entryNode.row == maze.entryNode.row && loaded.entryNode.col == maze.entryNode.col
+			&& loaded.exitNode.row == maze.exitNode.row && loaded.exitNode.col == maze.exitNode.col
+			&& std::equal(maze.verticalWalls.data(), maze.verticalWalls.data() + maze.verticalWalls.wordCount(), loaded.verticalWalls.rowWords(0));
+	}
+
+	const std::pair<std::size_t, std::uint32_t> corruptions[] = {
+		{ offsetof(MazeFileHeader, entryRow), 21 },
+		{ offsetof(MazeFileHeader, entryCol), 37 },
+		{ offsetof(MazeFileHeader, exitRow), 4000000 },
+		{ offsetof(MazeFileHeader, exitCol), 0xFFFFFFFF },
+		{ offsetof(MazeFileHeader, width), 0xFFFFFFFF },
+		{ offsetof(MazeFileHeader, width), 0x80000000 },
+		{ offsetof(MazeFileHeader, height), 0xFFFFFFFF },
+		{ offsetof(MazeFileHeader, height), 22 },
+	};
+	for (const auto & corruption : corruptions) {
+		const std::string patchedName = patchedMazeFile(fileName, corruption.first, corruption.second);
+		if (!loadFails(patchedName)) {
+			std::cerr << "a maze file with " << corruption.second << " at header offset " << corruption.first << " was accepted" << std::endl;
+			passed = false;
+		}
+		std::filesystem::remove(patchedName);
+	}
+	std::filesystem::remove(fileName);
+	return passed;
+}
+
+// incremental repairs against fresh searches after every random wall edit, on generated mazes
+// and on random walls where edits connect and cut off whole regions
+bool checkIncrementalDistances()
+{
+	std::mt19937 rng = seededRandom(13);
+	BfsWorkspace workspace;
+	IncrementalDistances incremental;
+	DistanceMap entryMap;
+	DistanceMap exitMap;
+
+	for (unsigned i = 0; i < 200; ++i) {
+		const unsigned width = 1 + randomIndex(rng, 40);
+		const unsigned height = 1 + randomIndex(rng, 40);
+		Maze maze = i % 2 == 0 ? generateMaze(width, height, rng, workspace) : randomWalls(width, height, rng, 0.4);
+		if (i % 2 == 1) {
+			placeEntryExit(maze, rng, workspace);
+		}
+		incremental.build(maze, workspace);
+
+		for (unsigned edit = 0; edit < 50; ++edit) {
+			const bool closed = randomIndex(rng, 2) == 0;
+			if (randomIndex(rng, 2) == 0) {
+				incremental.setWall(maze, Orientation::Horizontal, randomIndex(rng, height + 1), randomIndex(rng, width), closed);
+			}
+			else {
+				incremental.setWall(maze, Orientation::Vertical, randomIndex(rng, width + 1), randomIndex(rng, height), closed);
+			}
+
+			workspace.run(maze, maze.entryNode, entryMap);
+			workspace.run(maze, maze.exitNode, exitMap);
+			bool same = incremental.entryDistances().cells == entryMap.cells && incremental.exitDistances().cells == exitMap.cells;
+			for (std::size_t cell = 0; same && cell < entryMap.cells.size(); ++cell) {
+				same = maze.visualizedDMap.cells[cell] == std::min(entryMap.cells[cell], exitMap.cells[cell]);
+			}
+			if (!same) {
+				std::cerr << "incremental distances differ from a new search after edit " << edit << " of a " << width << "x" << height << " maze" << std::endl;
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+// true when cells is a walk through open walls from a to b with length steps
+bool isPath(const Maze & maze, const std::vector<Node> & cells, const Node & a, const Node & b, const unsigned length)
+{
+	if (cells.size() != length + 1 || !sameNodes({ cells.front() }, { a }) || !sameNodes({ cells.back() }, { b })) {
+		return false;
+	}
+	for (std::size_t i = 1; i < cells.size(); ++i) {
+		const Node & n = cells[i - 1];
+		const Node & next = cells[i];
+		const bool step = (next.row + 1 == n.row && next.col == n.col && maze.isOpenToTop(n.row, n.col))
+			|| (next.row == n.row + 1 && next.col == n.col && maze.isOpenToBottom(n.row, n.col))
+			|| (next.row == n.row && next.col + 1 == n.col && maze.isOpenToLeft(n.row, n.col))
+			|| (next.row == n.row && next.col == n.col + 1 && maze.isOpenToRight(n.row, n.col));
+		if (!step) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// distances and paths of the index against the queue search, before and after a save and load,
+// on perfect mazes, generated mazes with loops and random walls with unreachable regions
+bool checkPathIndex()
+{
+	std::mt19937 rng = seededRandom(11);
+	BfsWorkspace workspace;
+	DistanceMap map;
+	const std::string fileName = (std::filesystem::temp_directory_path() / "maze_check.index").string();
+
+	for (unsigned i = 0; i < 120; ++i) {
+		const unsigned width = 1 + randomIndex(rng, 50);
+		const unsigned height = 1 + randomIndex(rng, 50);
+		std::unique_ptr<Maze> maze;
+		if (i % 3 == 0) {
+			MazeRowCopy copy;
+			generateStreaming(width, height, rng, copy);
+			maze = std::move(copy.maze);
+		}
+		else {
+			maze.reset(new Maze(randomWalls(width, height, rng, i % 3 == 1 ? 0.0 : 0.45)));
+			if (i % 3 == 1) {
+				generateArea(*maze, rng, 0, 0, width, height);
+			}
+		}
+
+		PathIndex built;
+		built.build(*maze);
+		built.save(fileName);
+		PathIndex loaded;
+		loaded.load(fileName);
+
+		for (unsigned query = 0; query < 20; ++query) {
+			const Node a(randomIndex(rng, height), randomIndex(rng, width));
+			const Node b(randomIndex(rng, height), randomIndex(rng, width));
+			workspace.run(*maze, a, map);
+			const unsigned expected = map[b.row][b.col];
+			for (const PathIndex * index : { &built, &loaded }) {
+				const std::vector<Node> path = index->path(a, b);
+				const bool matches = expected == DistanceMap::unreachable() ? path.empty() : isPath(*maze, path, a, b, expected);
+				if (index->distance(a, b) != expected || !matches) {
+					std::cerr << "path index differs from the queue search on a " << width << "x" << height << " maze" << (index == &loaded ? " after loading" : "") << std::endl;
+					return false;
+				}
+			}
+		}
+	}
+
+	// parents outside of the maze, a parent loop, a junction outside of the maze and a missing byte
+	bool passed = true;
+	const std::pair<std::size_t, std::uint32_t> corruptions[] = {
+		{ 28, 0x01010101 },
+		{ 28, 0x00000304 },
+		{ 28 + 50 * 50, 0xFFFFFFFF },
+	};
+	{
+		Maze maze(50, 50);
+		generateArea(maze, rng, 0, 0, 50, 50);
+		PathIndex index;
+		index.build(maze);
+		index.save(fileName);
+	}
+	for (const auto & corruption : corruptions) {
+		const std::string patchedName = patchedMazeFile(fileName, corruption.first, corruption.second);
+		PathIndex index;
+		try {
+			index.load(patchedName);
+			std::cerr << "a path index with " << corruption.second << " at offset " << corruption.first << " was accepted" << std::endl;
+			passed = false;
+		}
+		catch (const std::runtime_error &) {
+		}
+		std::filesystem::remove(patchedName);
+	}
+	std::filesystem::resize_file(fileName, std::filesystem::file_size(fileName) - 1);
+	try {
+		PathIndex index;
+		index.load(fileName);
+		std::cerr << "a truncated path index was accepted" << std::endl;
+		passed = false;
+	}
+	catch (const std::runtime_error &) {
+	}
+	std::filesystem::remove(fileName);
+	return passed;
+}
+
+int main()
+{
+	const std::pair<const char *, bool (*)()> checks[] = {
+		{ "bitboard solver", &checkBitboardSolver },
+		{ "parallel generation", &checkParallelGeneration },
+		{ "longest path", &checkLongestPath },
+		{ "maze files", &checkMazeFiles },
+		{ "path index", &checkPathIndex },
+		{ "incremental distances", &checkIncrementalDistances },
+	};
+
+	bool passed = true;
+	for (const auto & check : checks) {
+		const bool result = check.second();
+		std::cout << (result ? "ok     " : "FAILED ") << check.first << std::endl;
+		passed = passed && result;
+	}
+	return passed ? 0 : 1;
+}
@@ -0,0 +1,4318 @@
+﻿// maze.h : maze storage, generation, searches and output, shared by the batch driver and the benchmarks.
+//
+
+#pragma once
+
+#include <vector>
+#include <array>
+#include <random>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <charconv>
+#include <cstdio>
+#include <limits>
+#include <algorithm>
+#include <iterator>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <map>
+#include <utility>
+#include <queue>
+#include <filesystem>
+#include <stdexcept>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// Optional in-process counters, compiled in with MAZE_INSTRUMENTATION.
+// Without it the MAZE_ hooks below expand to nothing and every counter stays zero.
+enum class Phase { GenerateArea, PlaceEntryExit, DistanceMap, MinMap, SearchMaximums, SearchMaximumsAtEdge, PrintText, PrintSvg, PrintPdf, SaveMaze, Count };
+
+const unsigned phaseCount = unsigned(Phase::Count);
+
+inline const char * phaseName(const Phase phase)
+{
+	static const char * const names[] = { "generateArea", "placeEntryExit", "distanceMap", "minMap", "searchMaximums", "searchMaximumsAtEdge", "printText", "printSvg", "printPdf", "saveMaze" };
+	return names[unsigned(phase)];
+}
+
+// Totals of all threads since the last reset. Phases can nest, placeEntryExit includes the
+// time of its distance maps.
+struct MazeCounters {
+	void reset()
+	{
+		for (unsigned i = 0; i < phaseCount; ++i) {
+			phaseCalls[i] = 0;
+			phaseNanoseconds[i] = 0;
+		}
+		cellsExpanded = 0;
+		peakQueueLength = 0;
+		peakGeneratorDepth = 0;
+		allocations = 0;
+		allocatedBytes = 0;
+		bytesWritten = 0;
+	}
+
+	static void add(std::atomic<std::uint64_t> & counter, const std::uint64_t value)
+	{
+		counter.fetch_add(value, std::memory_order_relaxed);
+	}
+
+	static void raise(std::atomic<std::uint64_t> & peak, const std::uint64_t value)
+	{
+		std::uint64_t current = peak.load(std::memory_order_relaxed);
+		while (value > current && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+		}
+	}
+
+	// one JSON object, nested lines start with indent
+	void writeJson(std::ostream & out, const std::string & indent = "") const
+	{
+#if defined(MAZE_INSTRUMENTATION)
+		out << "{\n" << indent << "  \"instrumentation\": true,\n";
+#else
+		out << "{\n" << indent << "  \"instrumentation\": false,\n";
+#endif
+		out << indent << "  \"phases\": {";
+		for (unsigned i = 0; i < phaseCount; ++i) {
+			out << (i == 0 ? "\n" : ",\n") << indent << "    \"" << phaseName(Phase(i)) << "\": { \"calls\": " << phaseCalls[i].load()
+				<< ", \"seconds\": " << double(phaseNanoseconds[i].load()) / 1e9 << " }";
+		}
+		out << "\n" << indent << "  },\n"
+			<< indent << "  \"cellsExpanded\": " << cellsExpanded.load() << ",\n"
+			<< indent << "  \"peakQueueLength\": " << peakQueueLength.load() << ",\n"
+			<< indent << "  \"peakGeneratorDepth\": " << peakGeneratorDepth.load() << ",\n"
+			<< indent << "  \"allocations\": " << allocations.load() << ",\n"
+			<< indent << "  \"allocatedBytes\": " << allocatedBytes.load() << ",\n"
+			<< indent << "  \"bytesWritten\": " << bytesWritten.load() << "\n"
+			<< indent << "}";
+	}
+
+	std::atomic<std::uint64_t> phaseCalls[phaseCount] = {};
+	std::atomic<std::uint64_t> phaseNanoseconds[phaseCount] = {};
+	std::atomic<std::uint64_t> cellsExpanded{ 0 }; // cells taken from a breadth first search queue
+	std::atomic<std::uint64_t> peakQueueLength{ 0 }; // longest breadth first search queue
+	std::atomic<std::uint64_t> peakGeneratorDepth{ 0 }; // deepest area stack of the iterative generator
+	std::atomic<std::uint64_t> allocations{ 0 }; // calls of the global operator new
+	std::atomic<std::uint64_t> allocatedBytes{ 0 };
+	std::atomic<std::uint64_t> bytesWritten{ 0 }; // maze, index and vector files and text output
+};
+
+// constant initialized, so the allocation counter works before other globals are constructed
+inline MazeCounters mazeCounters;
+
+// adds the lifetime of the timer to a phase
+class PhaseTimer {
+public:
+	explicit PhaseTimer(const Phase phase) : phase(phase), start(std::chrono::steady_clock::now()) {}
+
+	~PhaseTimer()
+	{
+		const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+		MazeCounters::add(mazeCounters.phaseCalls[unsigned(phase)], 1);
+		MazeCounters::add(mazeCounters.phaseNanoseconds[unsigned(phase)], std::uint64_t(elapsed.count()));
+	}
+
+	PhaseTimer(const PhaseTimer &) = delete;
+	PhaseTimer & operator=(const PhaseTimer &) = delete;
+
+private:
+	const Phase phase;
+	const std::chrono::steady_clock::time_point start;
+};
+
+#if defined(MAZE_INSTRUMENTATION)
+#define MAZE_PHASE(name) const PhaseTimer phaseTimer(Phase::name)
+#define MAZE_COUNT(counter, value) MazeCounters::add(mazeCounters.counter, std::uint64_t(value))
+#define MAZE_PEAK(counter, value) MazeCounters::raise(mazeCounters.counter, std::uint64_t(value))
+
+// Replaces the global operator new and delete to count allocations. Used once at namespace
+// scope in the source file with main, the replacements may not be inline. They are also kept
+// out of line, otherwise GCC sees free called on memory from operator new after inlining and
+// warns with -Wmismatched-new-delete.
+#if defined(_MSC_VER)
+#define MAZE_NOINLINE __declspec(noinline)
+#else
+#define MAZE_NOINLINE __attribute__((noinline))
+#endif
+
+#define MAZE_COUNT_ALLOCATIONS \
+	MAZE_NOINLINE void * operator new(const std::size_t size) \
+	{ \
+		MAZE_COUNT(allocations, 1); \
+		MAZE_COUNT(allocatedBytes, size); \
+		if (void * const memory = std::malloc(size != 0 ? size : 1)) { \
+			return memory; \
+		} \
+		throw std::bad_alloc(); \
+	} \
+	MAZE_NOINLINE void operator delete(void * const memory) noexcept { std::free(memory); } \
+	MAZE_NOINLINE void operator delete(void * const memory, std::size_t) noexcept { std::free(memory); }
+#else
+#define MAZE_PHASE(name) ((void)0)
+#define MAZE_COUNT(counter, value) ((void)0)
+#define MAZE_PEAK(counter, value) ((void)0)
+#define MAZE_COUNT_ALLOCATIONS
+#endif
+
+struct Node {
+	unsigned row;
+	unsigned col;
+	Node() : row(0), col(0) {}
+	Node(unsigned row, unsigned col) : row(row), col(col) {}
+};
+
+// Flat row-major distance buffer. Cells that cannot be reached hold unreachable().
+// The distance type is a template parameter so small mazes can use 16 bit distances.
+template <typename Distance>
+class BasicDistanceMap {
+public:
+	BasicDistanceMap() : width(0), height(0) {}
+	BasicDistanceMap(const unsigned width, const unsigned height)
+		: width(width), height(height), cells(std::size_t(width) * height, unreachable())
+	{
+
+	}
+
+	static Distance unreachable() { return std::numeric_limits<Distance>::max(); }
+
+	// resizes and clears the map, keeping the allocated buffer when possible
+	void reset(const unsigned newWidth, const unsigned newHeight)
+	{
+		width = newWidth;
+		height = newHeight;
+		cells.assign(std::size_t(width) * height, unreachable());
+	}
+
+	template <typename OtherDistance>
+	void assign(const BasicDistanceMap<OtherDistance> & other)
+	{
+		width = other.width;
+		height = other.height;
+		cells.resize(other.cells.size());
+		for (std::size_t i = 0; i < cells.size(); ++i) {
+			cells[i] = other.cells[i] == other.unreachable() ? unreachable() : Distance(other.cells[i]);
+		}
+	}
+
+	Distance * operator[](const unsigned row) { return cells.data() + std::size_t(row) * width; }
+	const Distance * operator[](const unsigned row) const { return cells.data() + std::size_t(row) * width; }
+
+	unsigned width;
+	unsigned height;
+	std::vector<Distance> cells;
+};
+
+using DistanceMap = BasicDistanceMap<std::uint32_t>;
+using CompactDistanceMap = BasicDistanceMap<std::uint16_t>;
+
+// Row-major packed bit matrix in a single allocation.
+// Every row starts on a fresh 64 bit word, so a whole row can be read as a bitmask.
+// Padding bits after the last column are always kept zero.
+class BitGrid {
+public:
+	BitGrid(const unsigned rows, const unsigned cols, const bool value)
+		: rows(rows), cols(cols), wordsPerRow((cols + 63) / 64),
+		words(std::size_t(rows) * wordsPerRow, value ? ~std::uint64_t(0) : 0)
+	{
+		const unsigned usedBits = cols % 64;
+		if (value && usedBits != 0) {
+			const std::uint64_t lastWordMask = (std::uint64_t(1) << usedBits) - 1;
+			for (unsigned row = 0; row < rows; ++row) {
+				words[std::size_t(row) * wordsPerRow + wordsPerRow - 1] = lastWordMask;
+			}
+		}
+	}
+
+	bool get(const unsigned row, const unsigned col) const
+	{
+		return (words[index(row, col)] >> (col % 64)) & 1;
+	}
+
+	void set(const unsigned row, const unsigned col, const bool value)
+	{
+		const std::uint64_t bit = std::uint64_t(1) << (col % 64);
+		std::uint64_t & word = words[index(row, col)];
+		word = value ? (word | bit) : (word & ~bit);
+	}
+
+	// clears a bit with an atomic read-modify-write, for grids written by several threads
+	void clearShared(const unsigned row, const unsigned col)
+	{
+		std::uint64_t & word = words[index(row, col)];
+		const std::uint64_t mask = ~(std::uint64_t(1) << (col % 64));
+#if defined(_MSC_VER)
+		_InterlockedAnd64(reinterpret_cast<volatile long long *>(&word), static_cast<long long>(mask));
+#else
+		__atomic_fetch_and(&word, mask, __ATOMIC_RELAXED);
+#endif
+	}
+
+	const std::uint64_t * rowWords(const unsigned row) const
+	{
+		return words.data() + std::size_t(row) * wordsPerRow;
+	}
+
+	const std::uint64_t * data() const { return words.data(); }
+	std::size_t wordCount() const { return words.size(); }
+
+	const unsigned rows;
+	const unsigned cols;
+	const unsigned wordsPerRow;
+
+private:
+	std::size_t index(const unsigned row, const unsigned col) const
+	{
+		return std::size_t(row) * wordsPerRow + col / 64;
+	}
+
+	std::vector<std::uint64_t> words;
+};
+
+// Read-only BitGrid over memory owned by someone else, e.g. a mapped file.
+class BitGridView {
+public:
+	BitGridView(const std::uint64_t * words, const unsigned rows, const unsigned cols)
+		: rows(rows), cols(cols), wordsPerRow((cols + 63) / 64), words(words)
+	{
+
+	}
+
+	bool get(const unsigned row, const unsigned col) const
+	{
+		return (rowWords(row)[col / 64] >> (col % 64)) & 1;
+	}
+
+	const std::uint64_t * rowWords(const unsigned row) const
+	{
+		return words + std::size_t(row) * wordsPerRow;
+	}
+
+	const std::uint64_t * data() const { return words; }
+	std::size_t wordCount() const { return std::size_t(rows) * wordsPerRow; }
+
+	const unsigned rows;
+	const unsigned cols;
+	const unsigned wordsPerRow;
+
+private:
+	const std::uint64_t * const words;
+};
+
+// Read-only DistanceMap over memory owned by someone else.
+class DistanceMapView {
+public:
+	DistanceMapView(const std::uint32_t * cells, const unsigned width, const unsigned height)
+		: width(cells ? width : 0), height(cells ? height : 0), cells(cells)
+	{
+
+	}
+
+	static std::uint32_t unreachable() { return DistanceMap::unreachable(); }
+
+	const std::uint32_t * operator[](const unsigned row) const { return cells + std::size_t(row) * width; }
+
+	const unsigned width;
+	const unsigned height;
+
+private:
+	const std::uint32_t * const cells;
+};
+
+enum class Orientation { Horizontal, Vertical };
+
+// Read accessors shared by every maze storage.
+// Derived provides width, height and the horizontalWalls / verticalWalls grids.
+template <typename Derived>
+class MazeWalls {
+public:
+	// wall on the top side of the cell, row can be height for the bottom border
+	bool hasHorizontalWall(const unsigned row, const unsigned col) const { return self().horizontalWalls.get(row, col); }
+	// wall on the left side of the cell, col can be width for the right border
+	bool hasVerticalWall(const unsigned row, const unsigned col) const { return self().verticalWalls.get(row, col); }
+
+	// passage checks between neighbouring cells, the outer border never counts as open
+	bool isOpenToTop(const unsigned row, const unsigned col) const { return row > 0 && !hasHorizontalWall(row, col); }
+	bool isOpenToBottom(const unsigned row, const unsigned col) const { return row < self().height - 1 && !hasHorizontalWall(row + 1, col); }
+	bool isOpenToLeft(const unsigned row, const unsigned col) const { return col > 0 && !hasVerticalWall(row, col); }
+	bool isOpenToRight(const unsigned row, const unsigned col) const { return col < self().width - 1 && !hasVerticalWall(row, col + 1); }
+
+private:
+	const Derived & self() const { return static_cast<const Derived &>(*this); }
+};
+
+class Maze : public MazeWalls<Maze> {
+public:
+	Maze(const unsigned width, const unsigned height)
+		: width(width), height(height),
+		horizontalWalls(height + 1, width, true),
+		verticalWalls(height, width + 1, true)
+	{
+
+	}
+
+	void setHorizontalWall(const unsigned row, const unsigned col, const bool closed) { horizontalWalls.set(row, col, closed); }
+	void setVerticalWall(const unsigned row, const unsigned col, const bool closed) { verticalWalls.set(row, col, closed); }
+
+	// opens one element of a wall line: a row of horizontal walls or a column of vertical walls
+	void openWall(const Orientation orientation, const unsigned line, const unsigned element)
+	{
+		if (orientation == Orientation::Horizontal) {
+			horizontalWalls.set(line, element, false);
+		}
+		else {
+			verticalWalls.set(element, line, false);
+		}
+	}
+
+	// same as openWall, safe while other threads open walls in the same rows
+	void openWallShared(const Orientation orientation, const unsigned line, const unsigned element)
+	{
+		if (orientation == Orientation::Horizontal) {
+			horizontalWalls.clearShared(line, element);
+		}
+		else {
+			verticalWalls.clearShared(element, line);
+		}
+	}
+
+	const unsigned width;
+	const unsigned height;
+	BitGrid horizontalWalls; // (height + 1) x width
+	BitGrid verticalWalls; // height x (width + 1)
+
+	Node entryNode;
+	Node exitNode;
+
+	DistanceMap visualizedDMap;
+};
+
+
+// Versioned binary maze file, all values little endian:
+//   header (MazeFileHeader, 64 bytes)
+//   horizontal walls: (height + 1) rows of BitGrid words
+//   vertical walls: height rows of BitGrid words
+//   optional distance map: width * height 32 bit distances, row-major
+// Sections start on 8 byte boundaries and keep the in-memory BitGrid layout, so a mapped
+// file can be used without decoding.
+struct MazeFileHeader {
+	char magic[4]; // "MAZE"
+	std::uint32_t version;
+	std::uint32_t width;
+	std::uint32_t height;
+	std::uint32_t entryRow;
+	std::uint32_t entryCol;
+	std::uint32_t exitRow;
+	std::uint32_t exitCol;
+	std::uint32_t flags;
+	std::uint32_t reserved;
+	std::uint64_t horizontalWallsOffset;
+	std::uint64_t verticalWallsOffset;
+	std::uint64_t distanceMapOffset; // 0 without a distance map
+};
+
+static_assert(sizeof(MazeFileHeader) == 64, "the header is part of the file format");
+
+const std::uint32_t mazeFileVersion = 1;
+
+inline bool isLittleEndian()
+{
+	const std::uint16_t probe = 1;
+	unsigned char first;
+	std::memcpy(&first, &probe, 1);
+	return first == 1;
+}
+
+template <typename MazeType>
+void saveMaze(const MazeType & maze, const std::string & fileName, const bool withDistanceMap)
+{
+	if (!isLittleEndian()) {
+		throw std::runtime_error("maze files can only be written on little endian machines");
+	}
+
+	const std::size_t cells = std::size_t(maze.width) * maze.height;
+	const bool hasDistanceMap = withDistanceMap && maze.visualizedDMap.width == maze.width && maze.visualizedDMap.height == maze.height;
+
+	MazeFileHeader header = {};
+	std::memcpy(header.magic, "MAZE", 4);
+	header.version = mazeFileVersion;
+	header.width = maze.width;
+	header.height = maze.height;
+	header.entryRow = maze.entryNode.row;
+	header.entryCol = maze.entryNode.col;
+	header.exitRow = maze.exitNode.row;
+	header.exitCol = maze.exitNode.col;
+	header.horizontalWallsOffset = sizeof(MazeFileHeader);
+	header.verticalWallsOffset = header.horizontalWallsOffset + maze.horizontalWalls.wordCount() * 8;
+	if (hasDistanceMap) {
+		header.flags = 1;
+		header.distanceMapOffset = header.verticalWallsOffset + maze.verticalWalls.wordCount() * 8;
+	}
+
+	MAZE_PHASE(SaveMaze);
+	std::ofstream f(fileName, std::ios::binary);
+	f.write(reinterpret_cast<const char *>(&header), sizeof(header));
+	f.write(reinterpret_cast<const char *>(maze.horizontalWalls.data()), maze.horizontalWalls.wordCount() * 8);
+	f.write(reinterpret_cast<const char *>(maze.verticalWalls.data()), maze.verticalWalls.wordCount() * 8);
+	if (hasDistanceMap) {
+		f.write(reinterpret_cast<const char *>(maze.visualizedDMap[0]), cells * 4);
+		// keeps the file a multiple of 8 bytes
+		if (cells % 2 != 0) {
+			f.write("\0\0\0\0", 4);
+		}
+	}
+	if (!f) {
+		throw std::runtime_error("cannot write " + fileName);
+	}
+	MAZE_COUNT(bytesWritten, f.tellp());
+}
+
+// Read-only memory mapping of a whole file.
+class MappedFile {
+public:
+	explicit MappedFile(const std::string & fileName)
+	{
+#if defined(_WIN32)
+		file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE) {
+			throw std::runtime_error("cannot open " + fileName);
+		}
+		LARGE_INTEGER fileSize;
+		GetFileSizeEx(file, &fileSize);
+		length = std::size_t(fileSize.QuadPart);
+		mapping = length ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+		bytes = mapping ? static_cast<const unsigned char *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+#else
+		fd = open(fileName.c_str(), O_RDONLY);
+		if (fd < 0) {
+			throw std::runtime_error("cannot open " + fileName);
+		}
+		struct stat status;
+		fstat(fd, &status);
+		length = std::size_t(status.st_size);
+		void * address = length ? mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+		bytes = address != MAP_FAILED ? static_cast<const unsigned char *>(address) : nullptr;
+#endif
+		if (length && !bytes) {
+			close();
+			throw std::runtime_error("cannot map " + fileName);
+		}
+	}
+
+	~MappedFile()
+	{
+		close();
+	}
+
+	MappedFile(const MappedFile &) = delete;
+	MappedFile & operator=(const MappedFile &) = delete;
+
+	const unsigned char * data() const { return bytes; }
+	std::size_t size() const { return length; }
+
+private:
+	void close()
+	{
+#if defined(_WIN32)
+		if (bytes) {
+			UnmapViewOfFile(bytes);
+		}
+		if (mapping) {
+			CloseHandle(mapping);
+		}
+		CloseHandle(file);
+#else
+		if (bytes) {
+			munmap(const_cast<unsigned char *>(bytes), length);
+		}
+		::close(fd);
+#endif
+		bytes = nullptr;
+	}
+
+#if defined(_WIN32)
+	HANDLE file;
+	HANDLE mapping;
+#else
+	int fd;
+#endif
+	const unsigned char * bytes;
+	std::size_t length;
+};
+
+// A maze file used in place. Offers the read accessors of Maze, so solvers and printers
+// work directly on the mapped bytes.
+class MappedMaze : public MazeWalls<MappedMaze> {
+public:
+	explicit MappedMaze(const std::string & fileName)
+		: file(fileName), header(readHeader(file, fileName)),
+		width(header.width), height(header.height),
+		horizontalWalls(section<std::uint64_t>(header.horizontalWallsOffset), height + 1, width),
+		verticalWalls(section<std::uint64_t>(header.verticalWallsOffset), height, width + 1),
+		entryNode(header.entryRow, header.entryCol),
+		exitNode(header.exitRow, header.exitCol),
+		visualizedDMap(header.distanceMapOffset ? section<std::uint32_t>(header.distanceMapOffset) : nullptr, width, height)
+	{
+
+	}
+
+	bool hasDistanceMap() const { return header.distanceMapOffset != 0; }
+
+private:
+	static MazeFileHeader readHeader(const MappedFile & file, const std::string & fileName)
+	{
+		MazeFileHeader header;
+		if (!isLittleEndian() || file.size() < sizeof(header)) {
+			throw std::runtime_error(fileName + " is not a maze file");
+		}
+		std::memcpy(&header, file.data(), sizeof(header));
+		// the vertical walls have width + 1 columns, which has to fit into 32 bits as well
+		if (std::memcmp(header.magic, "MAZE", 4) != 0 || header.version != mazeFileVersion || header.width == 0 || header.height == 0
+			|| header.width == std::numeric_limits<std::uint32_t>::max()) {
+			throw std::runtime_error(fileName + " is not a maze file");
+		}
+		if (header.entryRow >= header.height || header.entryCol >= header.width || header.exitRow >= header.height || header.exitCol >= header.width) {
+			throw std::runtime_error(fileName + " has entry or exit outside of the maze");
+		}
+
+		const std::uint64_t width = header.width;
+		const std::uint64_t height = header.height;
+		const std::uint64_t horizontalSize = (height + 1) * ((width + 63) / 64) * 8;
+		const std::uint64_t verticalSize = height * ((width + 64) / 64) * 8;
+		const std::uint64_t distanceSize = width * height * 4;
+		const auto fits = [&](const std::uint64_t offset, const std::uint64_t size) {
+			return offset % 8 == 0 && offset >= sizeof(header) && offset <= file.size() && size <= file.size() - offset;
+		};
+		if (!fits(header.horizontalWallsOffset, horizontalSize) || !fits(header.verticalWallsOffset, verticalSize)
+			|| (header.distanceMapOffset != 0 && !fits(header.distanceMapOffset, distanceSize))) {
+			throw std::runtime_error(fileName + " is truncated");
+		}
+		return header;
+	}
+
+	template <typename T>
+	const T * section(const std::uint64_t offset) const
+	{
+		return reinterpret_cast<const T *>(file.data() + offset);
+	}
+
+	MappedFile file;
+	const MazeFileHeader header;
+
+public:
+	const unsigned width;
+	const unsigned height;
+	const BitGridView horizontalWalls; // (height + 1) x width
+	const BitGridView verticalWalls; // height x (width + 1)
+
+	const Node entryNode;
+	const Node exitNode;
+
+	const DistanceMapView visualizedDMap; // empty when the file has no distance map
+};
+
+// Edge length in cells of the square tiles used by the file-backed grids.
+const unsigned mazeTileSize = 256;
+
+// Fixed size tiles of a grid stored in a scratch file. Up to capacity tiles are kept in
+// memory, the least recently used one is written back when another tile is needed. Tiles
+// that were never written read as the fill value, so a new grid takes no disk space.
+// The file is removed with the cache.
+template <typename T>
+class TileCache {
+public:
+	TileCache(const std::string & fileName, const std::size_t tileCount, const std::size_t tileElements, const T fill, const std::size_t capacity)
+		: fileName(fileName), tileElements(tileElements), fill(fill),
+		capacity(std::max<std::size_t>(1, std::min(capacity, tileCount))),
+		slotOfTile(tileCount, noSlot), stored(tileCount, false), clock(0),
+		file(fileName, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc)
+	{
+		if (!file) {
+			throw std::runtime_error("cannot create " + fileName);
+		}
+	}
+
+	~TileCache()
+	{
+		file.close();
+		std::error_code ignored;
+		std::filesystem::remove(fileName, ignored);
+	}
+
+	TileCache(const TileCache &) = delete;
+	TileCache & operator=(const TileCache &) = delete;
+
+	// elements of one tile, valid until another tile is requested
+	T * tile(const std::size_t index, const bool write)
+	{
+		std::size_t slot = slotOfTile[index];
+		if (slot == noSlot) {
+			slot = load(index);
+		}
+		slots[slot].lastUse = ++clock;
+		slots[slot].dirty = slots[slot].dirty || write;
+		return buffers[slot].get();
+	}
+
+	// every tile back to the fill value
+	void reset()
+	{
+		for (const Slot & slot : slots) {
+			slotOfTile[slot.tile] = noSlot;
+		}
+		slots.clear();
+		std::fill(stored.begin(), stored.end(), false);
+	}
+
+private:
+	struct Slot {
+		std::size_t tile;
+		std::uint64_t lastUse;
+		bool dirty;
+	};
+
+	static constexpr std::size_t noSlot = ~std::size_t(0);
+
+	std::size_t load(const std::size_t index)
+	{
+		std::size_t slot = slots.size();
+		if (slot < capacity) {
+			slots.push_back({ index, 0, false });
+			if (buffers.size() < slots.size()) {
+				buffers.emplace_back(new T[tileElements]);
+			}
+		}
+		else {
+			slot = 0;
+			for (std::size_t i = 1; i < slots.size(); ++i) {
+				if (slots[i].lastUse < slots[slot].lastUse) {
+					slot = i;
+				}
+			}
+			Slot & victim = slots[slot];
+			if (victim.dirty) {
+				file.seekp(offset(victim.tile));
+				file.write(reinterpret_cast<const char *>(buffers[slot].get()), tileElements * sizeof(T));
+				if (!file) {
+					throw std::runtime_error("cannot write " + fileName);
+				}
+				stored[victim.tile] = true;
+			}
+			slotOfTile[victim.tile] = noSlot;
+			victim = { index, 0, false };
+		}
+
+		T * const elements = buffers[slot].get();
+		if (stored[index]) {
+			file.seekg(offset(index));
+			file.read(reinterpret_cast<char *>(elements), tileElements * sizeof(T));
+			if (!file) {
+				throw std::runtime_error("cannot read " + fileName);
+			}
+		}
+		else {
+			std::fill(elements, elements + tileElements, fill);
+		}
+		slotOfTile[index] = slot;
+		return slot;
+	}
+
+	std::streamoff offset(const std::size_t index) const
+	{
+		return std::streamoff(index * tileElements * sizeof(T));
+	}
+
+	const std::string fileName;
+	const std::size_t tileElements;
+	const T fill;
+	const std::size_t capacity;
+	std::vector<std::size_t> slotOfTile;
+	std::vector<bool> stored; // the tile has a copy in the file
+	std::vector<Slot> slots;
+	std::vector<std::unique_ptr<T[]>> buffers;
+	std::uint64_t clock;
+	std::fstream file;
+};
+
+// BitGrid kept in tiles of mazeTileSize x mazeTileSize bits. Not thread safe, not even
+// for reading, since every access goes through the tile cache.
+class TiledBitGrid {
+public:
+	TiledBitGrid(const std::string & fileName, const unsigned rows, const unsigned cols, const bool value, const std::size_t cacheBytes)
+		: rows(rows), cols(cols), wordsPerRow((cols + 63) / 64),
+		tileColumns((cols + mazeTileSize - 1) / mazeTileSize),
+		tiles(fileName, std::size_t(tileColumns) * ((rows + mazeTileSize - 1) / mazeTileSize), mazeTileSize * tileWords,
+			value ? ~std::uint64_t(0) : 0, cacheBytes / (mazeTileSize * tileWords * 8)),
+		rowBuffer(wordsPerRow)
+	{
+
+	}
+
+	bool get(const unsigned row, const unsigned col) const
+	{
+		return (word(row, col, false) >> (col % 64)) & 1;
+	}
+
+	void set(const unsigned row, const unsigned col, const bool value)
+	{
+		const std::uint64_t mask = std::uint64_t(1) << (col % 64);
+		std::uint64_t & w = word(row, col, true);
+		w = value ? (w | mask) : (w & ~mask);
+	}
+
+	// the row gathered from its tiles in BitGrid layout, valid until the next call
+	const std::uint64_t * rowWords(const unsigned row) const
+	{
+		for (unsigned tileColumn = 0; tileColumn < tileColumns; ++tileColumn) {
+			const std::uint64_t * source = tiles.tile(tileIndex(row, tileColumn * mazeTileSize), false) + (row % mazeTileSize) * tileWords;
+			const unsigned first = tileColumn * tileWords;
+			std::copy(source, source + std::min(tileWords, wordsPerRow - first), rowBuffer.begin() + first);
+		}
+		if (cols % 64 != 0) {
+			rowBuffer.back() &= (std::uint64_t(1) << (cols % 64)) - 1;
+		}
+		return rowBuffer.data();
+	}
+
+	const unsigned rows;
+	const unsigned cols;
+	const unsigned wordsPerRow;
+
+private:
+	static constexpr unsigned tileWords = mazeTileSize / 64;
+
+	std::size_t tileIndex(const unsigned row, const unsigned col) const
+	{
+		return std::size_t(row / mazeTileSize) * tileColumns + col / mazeTileSize;
+	}
+
+	std::uint64_t & word(const unsigned row, const unsigned col, const bool write) const
+	{
+		return tiles.tile(tileIndex(row, col), write)[(row % mazeTileSize) * tileWords + (col % mazeTileSize) / 64];
+	}
+
+	const unsigned tileColumns;
+	mutable TileCache<std::uint64_t> tiles;
+	mutable std::vector<std::uint64_t> rowBuffer;
+};
+
+// DistanceMap kept in tiles of mazeTileSize x mazeTileSize cells, see TiledBitGrid.
+class TiledDistanceMap {
+public:
+	TiledDistanceMap(const std::string & fileName, const unsigned width, const unsigned height, const std::size_t cacheBytes)
+		: width(width), height(height),
+		tileColumns((width + mazeTileSize - 1) / mazeTileSize),
+		tileRows((height + mazeTileSize - 1) / mazeTileSize),
+		tiles(fileName, std::size_t(tileColumns) * tileRows, tileCells, unreachable(), cacheBytes / (tileCells * 4))
+	{
+
+	}
+
+	static std::uint32_t unreachable() { return DistanceMap::unreachable(); }
+
+	std::uint32_t get(const unsigned row, const unsigned col) const
+	{
+		return tiles.tile(tileIndex(row, col), false)[cellIndex(row, col)];
+	}
+
+	void set(const unsigned row, const unsigned col, const std::uint32_t distance)
+	{
+		tiles.tile(tileIndex(row, col), true)[cellIndex(row, col)] = distance;
+	}
+
+	// map[row][col] reads like an in-memory map
+	class Row {
+	public:
+		Row(const TiledDistanceMap & map, const unsigned row) : map(map), row(row) {}
+		std::uint32_t operator[](const unsigned col) const { return map.get(row, col); }
+
+	private:
+		const TiledDistanceMap & map;
+		const unsigned row;
+	};
+
+	Row operator[](const unsigned row) const { return Row(*this, row); }
+
+	// whole tiles for the tiled search, cells are row-major inside a tile
+	std::uint32_t * tile(const std::size_t index) { return tiles.tile(index, true); }
+
+	std::size_t tileIndex(const unsigned row, const unsigned col) const
+	{
+		return std::size_t(row / mazeTileSize) * tileColumns + col / mazeTileSize;
+	}
+
+	static unsigned cellIndex(const unsigned row, const unsigned col)
+	{
+		return (row % mazeTileSize) * mazeTileSize + col % mazeTileSize;
+	}
+
+	void reset() { tiles.reset(); }
+
+	const unsigned width;
+	const unsigned height;
+	const unsigned tileColumns;
+	const unsigned tileRows;
+
+private:
+	static constexpr unsigned tileCells = mazeTileSize * mazeTileSize;
+
+	mutable TileCache<std::uint32_t> tiles;
+};
+
+// Maze for sizes that do not fit into memory. Walls and the distance map live in tile
+// files inside directory, one maze per directory, and cacheBytes of tiles are kept in
+// memory. Offers the same accessors as Maze for the generator, the solvers and the printers.
+class TiledMaze : public MazeWalls<TiledMaze> {
+public:
+	TiledMaze(const unsigned width, const unsigned height, const std::string & directory, const std::size_t cacheBytes = std::size_t(512) << 20)
+		: width(width), height(height), directory(directory),
+		horizontalWalls(tileFile(directory, "horizontal-walls"), height + 1, width, true, cacheBytes / 8),
+		verticalWalls(tileFile(directory, "vertical-walls"), height, width + 1, true, cacheBytes / 8),
+		visualizedDMap(tileFile(directory, "distances"), width, height, cacheBytes / 4 * 3)
+	{
+
+	}
+
+	void setHorizontalWall(const unsigned row, const unsigned col, const bool closed) { horizontalWalls.set(row, col, closed); }
+	void setVerticalWall(const unsigned row, const unsigned col, const bool closed) { verticalWalls.set(row, col, closed); }
+
+	void openWall(const Orientation orientation, const unsigned line, const unsigned element)
+	{
+		if (orientation == Orientation::Horizontal) {
+			horizontalWalls.set(line, element, false);
+		}
+		else {
+			verticalWalls.set(element, line, false);
+		}
+	}
+
+private:
+	// Creates the tile directory and removes it again once the tile files are gone, declared
+	// before the grids so it outlives them. A directory that already existed is left alone.
+	class TileDirectory {
+	public:
+		explicit TileDirectory(const std::string & path) : path(path), created(std::filesystem::create_directories(path)) {}
+
+		~TileDirectory()
+		{
+			if (created) {
+				std::error_code ignored;
+				std::filesystem::remove(path, ignored);
+			}
+		}
+
+		TileDirectory(const TileDirectory &) = delete;
+		TileDirectory & operator=(const TileDirectory &) = delete;
+
+	private:
+		const std::string path;
+		const bool created;
+	};
+
+	static std::string tileFile(const std::string & directory, const char * name)
+	{
+		return (std::filesystem::path(directory) / (std::string(name) + ".tiles")).string();
+	}
+
+public:
+	const unsigned width;
+	const unsigned height;
+
+private:
+	const TileDirectory directory;
+
+public:
+	TiledBitGrid horizontalWalls; // (height + 1) x width
+	TiledBitGrid verticalWalls; // height x (width + 1)
+
+	Node entryNode;
+	Node exitNode;
+
+	TiledDistanceMap visualizedDMap;
+};
+
+// BitGrid with its capacity fixed at compile time, stored in place. The size is set at run
+// time up to the capacity, rows are packed like in BitGrid.
+template <unsigned MaxRows, unsigned MaxCols>
+class FixedBitGrid {
+public:
+	FixedBitGrid(const unsigned rows, const unsigned cols, const bool value)
+		: rows(rows), cols(cols), wordsPerRow((cols + 63) / 64)
+	{
+		words.fill(value ? ~std::uint64_t(0) : 0);
+		if (value && cols % 64 != 0) {
+			for (unsigned row = 0; row < rows; ++row) {
+				words[row * wordsPerRow + wordsPerRow - 1] = (std::uint64_t(1) << (cols % 64)) - 1;
+			}
+		}
+	}
+
+	bool get(const unsigned row, const unsigned col) const
+	{
+		return (words[row * wordsPerRow + col / 64] >> (col % 64)) & 1;
+	}
+
+	void set(const unsigned row, const unsigned col, const bool value)
+	{
+		const std::uint64_t bit = std::uint64_t(1) << (col % 64);
+		std::uint64_t & word = words[row * wordsPerRow + col / 64];
+		word = value ? (word | bit) : (word & ~bit);
+	}
+
+	const std::uint64_t * rowWords(const unsigned row) const { return words.data() + row * wordsPerRow; }
+
+	const std::uint64_t * data() const { return words.data(); }
+	std::size_t wordCount() const { return std::size_t(rows) * wordsPerRow; }
+
+	const unsigned rows;
+	const unsigned cols;
+	const unsigned wordsPerRow;
+
+private:
+	std::array<std::uint64_t, std::size_t(MaxRows) * ((MaxCols + 63) / 64)> words;
+};
+
+// DistanceMap with its capacity fixed at compile time, stored in place. Rows are packed for
+// the size given to reset.
+template <unsigned MaxWidth, unsigned MaxHeight>
+class FixedDistanceMap {
+public:
+	FixedDistanceMap() : width(0), height(0) {}
+
+	static std::uint32_t unreachable() { return DistanceMap::unreachable(); }
+
+	// same interface as BasicDistanceMap, the size has to fit into the capacity
+	void reset(const unsigned width, const unsigned height)
+	{
+		this->width = width;
+		this->height = height;
+		std::fill(cells.begin(), cells.begin() + std::size_t(width) * height, unreachable());
+	}
+
+	std::uint32_t * operator[](const unsigned row) { return cells.data() + row * width; }
+	const std::uint32_t * operator[](const unsigned row) const { return cells.data() + row * width; }
+
+	unsigned width;
+	unsigned height;
+	std::array<std::uint32_t, std::size_t(MaxWidth) * MaxHeight> cells;
+};
+
+// Maze of any size up to a capacity fixed at compile time. Walls and distances are stored in
+// place, so a maze is a single object without further allocations, and one instantiation
+// covers every size up to the capacity. Used for the batch sizes, see generateBatchMaze.
+template <unsigned MaxWidth, unsigned MaxHeight>
+class FixedMaze : public MazeWalls<FixedMaze<MaxWidth, MaxHeight>> {
+public:
+	FixedMaze(const unsigned width, const unsigned height)
+		: width(width), height(height), horizontalWalls(height + 1, width, true), verticalWalls(height, width + 1, true)
+	{
+		if (width == 0 || height == 0 || width > MaxWidth || height > MaxHeight) {
+			throw std::invalid_argument("maze size outside of the FixedMaze capacity");
+		}
+	}
+
+	void setHorizontalWall(const unsigned row, const unsigned col, const bool closed) { horizontalWalls.set(row, col, closed); }
+	void setVerticalWall(const unsigned row, const unsigned col, const bool closed) { verticalWalls.set(row, col, closed); }
+
+	void openWall(const Orientation orientation, const unsigned line, const unsigned element)
+	{
+		if (orientation == Orientation::Horizontal) {
+			horizontalWalls.set(line, element, false);
+		}
+		else {
+			verticalWalls.set(element, line, false);
+		}
+	}
+
+	const unsigned width;
+	const unsigned height;
+	FixedBitGrid<MaxHeight + 1, MaxWidth> horizontalWalls;
+	FixedBitGrid<MaxHeight, MaxWidth + 1> verticalWalls;
+
+	Node entryNode;
+	Node exitNode;
+
+	FixedDistanceMap<MaxWidth, MaxHeight> visualizedDMap;
+};
+
+// Read-only maze over the walls and distances of another maze, so code that only reads a
+// maze needs a single instantiation for every in-memory maze type.
+class MazeView : public MazeWalls<MazeView> {
+public:
+	template <typename MazeType>
+	explicit MazeView(const MazeType & maze)
+		: width(maze.width), height(maze.height),
+		horizontalWalls(maze.horizontalWalls.data(), maze.height + 1, maze.width),
+		verticalWalls(maze.verticalWalls.data(), maze.height, maze.width + 1),
+		entryNode(maze.entryNode), exitNode(maze.exitNode),
+		visualizedDMap(maze.visualizedDMap.width == maze.width ? maze.visualizedDMap[0] : nullptr, maze.width, maze.height)
+	{
+
+	}
+
+	const unsigned width;
+	const unsigned height;
+	const BitGridView horizontalWalls;
+	const BitGridView verticalWalls;
+
+	const Node entryNode;
+	const Node exitNode;
+
+	const DistanceMapView visualizedDMap; // empty when the maze has no distance map
+};
+
+// true when every distance and the unreachable marker fit into CompactDistanceMap
+template <typename MazeType>
+bool fitsCompactDistances(const MazeType & maze)
+{
+	return std::uint64_t(maze.width) * maze.height < std::numeric_limits<std::uint16_t>::max();
+}
+
+// Breadth first search with buffers that are kept between runs.
+// Once the workspace has seen the largest maze, running it does not allocate.
+class BfsWorkspace {
+public:
+	// multi-source search: every start node gets distance 0, each cell the distance to the closest one
+	template <typename MazeType, typename Map>
+	void run(const MazeType & maze, const Node * firstSource, const Node * lastSource, Map & map)
+	{
+		MAZE_PHASE(DistanceMap);
+		map.reset(maze.width, maze.height);
+		expand(maze, firstSource, lastSource, map);
+	}
+
+	template <typename MazeType, typename Map>
+	void run(const MazeType & maze, const Node & startNode, Map & map)
+	{
+		run(maze, &startNode, &startNode + 1, map);
+	}
+
+	// continues in a map that already holds distances, reaching only cells that are still
+	// unreachable; the sources must be unreachable as well
+	template <typename MazeType, typename Map>
+	void expand(const MazeType & maze, const Node * firstSource, const Node * lastSource, Map & map)
+	{
+		using Distance = decltype(Map::unreachable());
+
+		// every cell is queued at most once, so a flat buffer never wraps around
+		queue.resize(std::size_t(maze.width) * maze.height);
+		std::size_t head = 0;
+		std::size_t tail = 0;
+
+		for (const Node * source = firstSource; source != lastSource; ++source) {
+			if (map[source->row][source->col] != 0) {
+				map[source->row][source->col] = 0;
+				queue[tail++] = *source;
+			}
+		}
+
+		while (head != tail) {
+			MAZE_PEAK(peakQueueLength, tail - head);
+			const Node n = queue[head++];
+			Distance * const row = map[n.row];
+			const Distance distance = row[n.col] + 1;
+
+			if (maze.isOpenToTop(n.row, n.col) && map[n.row - 1][n.col] == map.unreachable()) {
+				queue[tail++] = Node(n.row - 1, n.col);
+				map[n.row - 1][n.col] = distance;
+			}
+			if (maze.isOpenToBottom(n.row, n.col) && map[n.row + 1][n.col] == map.unreachable()) {
+				queue[tail++] = Node(n.row + 1, n.col);
+				map[n.row + 1][n.col] = distance;
+			}
+			if (maze.isOpenToLeft(n.row, n.col) && row[n.col - 1] == map.unreachable()) {
+				queue[tail++] = Node(n.row, n.col - 1);
+				row[n.col - 1] = distance;
+			}
+			if (maze.isOpenToRight(n.row, n.col) && row[n.col + 1] == map.unreachable()) {
+				queue[tail++] = Node(n.row, n.col + 1);
+				row[n.col + 1] = distance;
+			}
+		}
+		MAZE_COUNT(cellsExpanded, tail);
+	}
+
+	// reusable result buffers for callers that only need a map temporarily
+	CompactDistanceMap compactMap;
+	DistanceMap wideMap;
+
+private:
+	std::vector<Node> queue;
+};
+
+template <typename MazeType>
+DistanceMap generateDistanceMap(const MazeType & maze, const Node & startNode)
+{
+	thread_local BfsWorkspace workspace; // keeps its queue between calls
+	DistanceMap map;
+	workspace.run(maze, startNode, map);
+	return map;
+}
+
+template <unsigned MaxWidth, unsigned MaxHeight>
+FixedDistanceMap<MaxWidth, MaxHeight> generateDistanceMap(const FixedMaze<MaxWidth, MaxHeight> & maze, const Node & startNode)
+{
+	thread_local BfsWorkspace workspace; // keeps its queue between calls
+	FixedDistanceMap<MaxWidth, MaxHeight> map;
+	workspace.run(maze, startNode, map);
+	return map;
+}
+
+// Breadth first search on a TiledMaze that works through the maze one tile at a time.
+// Cells reached across a tile border are queued on their tile, and the tile with the
+// smallest queued distance is searched next until its frontier has left it. Distances are
+// only touched inside the current tile, so the distance file is read and written in whole
+// tiles. In mazes with loops a later visit can still shorten distances of a tile, which
+// are then propagated again; a perfect maze visits every cell once.
+inline void runTiledBfs(const TiledMaze & maze, const Node * firstSource, const Node * lastSource, TiledDistanceMap & map)
+{
+	struct Entry {
+		std::uint32_t cell; // index inside the tile
+		std::uint32_t distance;
+	};
+	using TileDistance = std::pair<std::uint32_t, std::size_t>;
+
+	MAZE_PHASE(DistanceMap);
+	map.reset();
+
+	std::vector<std::vector<Entry>> inbox(std::size_t(map.tileColumns) * map.tileRows);
+	std::priority_queue<TileDistance, std::vector<TileDistance>, std::greater<TileDistance>> tiles;
+	std::vector<Entry> seeds;
+	std::vector<Entry> queue;
+
+	const auto enqueue = [&](const unsigned row, const unsigned col, const std::uint32_t distance) {
+		const std::size_t tile = map.tileIndex(row, col);
+		inbox[tile].push_back({ TiledDistanceMap::cellIndex(row, col), distance });
+		tiles.push({ distance, tile });
+	};
+
+	for (const Node * source = firstSource; source != lastSource; ++source) {
+		enqueue(source->row, source->col, 0);
+	}
+
+	while (!tiles.empty()) {
+		const std::size_t tile = tiles.top().second;
+		tiles.pop();
+		if (inbox[tile].empty()) {
+			continue; // already searched with an earlier entry of the heap
+		}
+
+		seeds.swap(inbox[tile]);
+		inbox[tile].clear();
+		std::sort(seeds.begin(), seeds.end(), [](const Entry & a, const Entry & b) { return a.distance < b.distance; });
+		queue.clear();
+
+		std::uint32_t * const distances = map.tile(tile);
+		const unsigned top = unsigned(tile / map.tileColumns) * mazeTileSize;
+		const unsigned left = unsigned(tile % map.tileColumns) * mazeTileSize;
+
+		// seeds and queue are both sorted by distance, merging them keeps the search breadth first
+		std::size_t seed = 0;
+		std::size_t head = 0;
+		while (seed < seeds.size() || head < queue.size()) {
+			MAZE_PEAK(peakQueueLength, seeds.size() - seed + queue.size() - head);
+			const bool fromQueue = seed == seeds.size() || (head < queue.size() && queue[head].distance <= seeds[seed].distance);
+			const Entry entry = fromQueue ? queue[head++] : seeds[seed++];
+			if (entry.distance >= distances[entry.cell]) {
+				continue;
+			}
+			distances[entry.cell] = entry.distance;
+			MAZE_COUNT(cellsExpanded, 1);
+
+			const unsigned row = top + entry.cell / mazeTileSize;
+			const unsigned col = left + entry.cell % mazeTileSize;
+			const std::uint32_t distance = entry.distance + 1;
+			const auto visit = [&](const unsigned nextRow, const unsigned nextCol) {
+				if (nextRow / mazeTileSize != row / mazeTileSize || nextCol / mazeTileSize != col / mazeTileSize) {
+					enqueue(nextRow, nextCol, distance);
+				}
+				else {
+					const std::uint32_t cell = TiledDistanceMap::cellIndex(nextRow, nextCol);
+					if (distance < distances[cell]) {
+						queue.push_back({ cell, distance });
+					}
+				}
+			};
+
+			if (maze.isOpenToTop(row, col)) {
+				visit(row - 1, col);
+			}
+			if (maze.isOpenToBottom(row, col)) {
+				visit(row + 1, col);
+			}
+			if (maze.isOpenToLeft(row, col)) {
+				visit(row, col - 1);
+			}
+			if (maze.isOpenToRight(row, col)) {
+				visit(row, col + 1);
+			}
+		}
+		seeds.clear();
+	}
+}
+
+inline void generateDistanceMap(const TiledMaze & maze, const Node & startNode, TiledDistanceMap & map)
+{
+	runTiledBfs(maze, &startNode, &startNode + 1, map);
+}
+
+template <typename MazeType, typename Distance>
+BasicDistanceMap<Distance> minMap(const MazeType & maze, const BasicDistanceMap<Distance> & map1, const BasicDistanceMap<Distance> & map2)
+{
+	MAZE_PHASE(MinMap);
+	BasicDistanceMap<Distance> map(maze.width, maze.height);
+
+	for (std::size_t i = 0; i < map.cells.size(); ++i) {
+		map.cells[i] = std::min(map1.cells[i], map2.cells[i]);
+	}
+
+	return map;
+}
+
+// unreachable cells are never reported as maximums
+template <typename Map>
+std::vector<Node> searchMaximums(const Map & map)
+{
+	using Distance = decltype(Map::unreachable());
+
+	MAZE_PHASE(SearchMaximums);
+	std::vector<Node> ret;
+	Distance maxValue = 0;
+
+	for (unsigned row = 0; row < map.height; ++row)
+	{
+		const Distance * const values = map[row];
+		for (unsigned col = 0; col < map.width; ++col)
+		{
+			if (values[col] == map.unreachable()) {
+				continue;
+			}
+			if (values[col] > maxValue) {
+				maxValue = values[col];
+				ret.clear();
+			}
+			if (values[col] == maxValue) {
+				ret.push_back(Node(row, col));
+			}
+		}
+	}
+
+	return ret;
+}
+
+template <typename MazeType, typename Map>
+std::vector<unsigned> searchMaximumsAtEdge(const MazeType & maze, const Map & map)
+{
+	using Distance = decltype(Map::unreachable());
+
+	MAZE_PHASE(SearchMaximumsAtEdge);
+	std::vector<unsigned> ret;
+	Distance maxValue = 0;
+
+	unsigned index = 0;
+	const auto check = [&](const Distance value) {
+		if (value != map.unreachable()) {
+			if (value > maxValue) {
+				maxValue = value;
+				ret.clear();
+			}
+			if (value == maxValue) {
+				ret.push_back(index);
+			}
+		}
+		index++;
+	};
+
+	for (unsigned col = 0; col < maze.width; col++) {
+		check(map[0][col]);
+	}
+	for (unsigned row = 0; row < maze.height; row++) {
+		check(map[row][maze.width - 1]);
+	}
+	for (unsigned col = maze.width-1; col < maze.width; col--) {
+		check(map[maze.height - 1][col]);
+	}
+	for (unsigned row = maze.height-1; row < maze.height; row--) {
+		check(map[row][0]);
+	}
+
+	return ret;
+}
+
+struct EdgePath {
+	Node first;
+	Node second;
+	unsigned length;
+};
+
+// Longest path between two border cells in a single pass, for mazes whose passages form a
+// tree. Going up the breadth first tree, every cell keeps its two longest branches down to a
+// border cell; the longest path is the best pair of branches meeting in one cell. Returns
+// false when the maze has loops or unreachable cells, where this would not be the longest
+// shortest path anymore.
+template <typename MazeType>
+bool findLongestEdgePath(const MazeType & maze, EdgePath & path)
+{
+	const unsigned width = maze.width;
+	const unsigned height = maze.height;
+	const std::size_t cells = std::size_t(width) * height;
+	const std::uint32_t none = ~std::uint32_t(0);
+
+	// breadth first order from cell 0, a parent always comes before its children
+	std::vector<std::uint32_t> order(cells);
+	std::vector<std::uint32_t> parent(cells, none);
+	order[0] = 0;
+	parent[0] = 0;
+	std::size_t visited = 1;
+	for (std::size_t head = 0; head < visited; ++head) {
+		const std::uint32_t cell = order[head];
+		const unsigned row = cell / width;
+		const unsigned col = cell % width;
+
+		bool loop = false;
+		const auto visit = [&](const std::uint32_t next) {
+			if (next == parent[cell]) {
+				return;
+			}
+			if (parent[next] != none) {
+				loop = true;
+				return;
+			}
+			parent[next] = cell;
+			order[visited++] = next;
+		};
+		if (maze.isOpenToTop(row, col)) {
+			visit(cell - width);
+		}
+		if (maze.isOpenToBottom(row, col)) {
+			visit(cell + width);
+		}
+		if (maze.isOpenToLeft(row, col)) {
+			visit(cell - 1);
+		}
+		if (maze.isOpenToRight(row, col)) {
+			visit(cell + 1);
+		}
+		if (loop) {
+			return false;
+		}
+	}
+	if (visited != cells) {
+		return false;
+	}
+
+	// the two longest branches of every cell and the border cells they end in
+	std::vector<std::uint32_t> first(cells, none);
+	std::vector<std::uint32_t> firstEnd(cells);
+	std::vector<std::uint32_t> second(cells, none);
+	std::vector<std::uint32_t> secondEnd(cells);
+	const auto offer = [&](const std::uint32_t cell, const std::uint32_t length, const std::uint32_t end) {
+		if (first[cell] == none || length > first[cell]) {
+			second[cell] = first[cell];
+			secondEnd[cell] = firstEnd[cell];
+			first[cell] = length;
+			firstEnd[cell] = end;
+		}
+		else if (second[cell] == none || length > second[cell]) {
+			second[cell] = length;
+			secondEnd[cell] = end;
+		}
+	};
+
+	// cell 0 is a border cell, the path from it to itself is the shortest candidate
+	path.first = Node(0, 0);
+	path.second = Node(0, 0);
+	path.length = 0;
+
+	for (std::size_t i = visited; i-- > 0;) {
+		const std::uint32_t cell = order[i];
+		const unsigned row = cell / width;
+		const unsigned col = cell % width;
+
+		// all children have been handled, so the branches of the cell are complete
+		if (row == 0 || row == height - 1 || col == 0 || col == width - 1) {
+			offer(cell, 0, cell);
+		}
+		if (second[cell] != none && first[cell] + second[cell] > path.length) {
+			path.first = Node(firstEnd[cell] / width, firstEnd[cell] % width);
+			path.second = Node(secondEnd[cell] / width, secondEnd[cell] % width);
+			path.length = first[cell] + second[cell];
+		}
+		if (i > 0 && first[cell] != none) {
+			offer(parent[cell], first[cell] + 1, firstEnd[cell]);
+		}
+	}
+	return true;
+}
+
+inline unsigned countTrailingZeros(const std::uint64_t value)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+	unsigned long index;
+	_BitScanForward64(&index, value);
+	return index;
+#elif defined(__GNUC__)
+	return __builtin_ctzll(value);
+#else
+	unsigned index = 0;
+	while (((value >> index) & 1) == 0) {
+		++index;
+	}
+	return index;
+#endif
+}
+
+// Breadth first search that expands a whole frontier at once.
+// Frontiers are kept as per-row bitmasks and grow by shifting them along precomputed
+// "open to the right" and "open downwards" masks, so one layer costs a few word
+// operations per row instead of a queue round trip per cell.
+// Every row is framed by a zero word on both sides and the grid by a zero row above and
+// below, so neighbouring words and rows can be read without bounds checks.
+class BitboardSolver {
+public:
+	BitboardSolver() : width(0), height(0), stride(0) {}
+	template <typename MazeType>
+	explicit BitboardSolver(const MazeType & maze) { load(maze); }
+
+	// precomputes the passage masks, buffers are kept when the solver is reused
+	template <typename MazeType>
+	void load(const MazeType & maze)
+	{
+		width = maze.width;
+		height = maze.height;
+		stride = maze.horizontalWalls.wordsPerRow + 2;
+
+		const std::size_t size = std::size_t(height + 2) * stride;
+		frontierFirst = frontierLast = edgeFirst = edgeLast = 0;
+		openRight.assign(size, 0);
+		openDown.assign(size, 0);
+		visited.assign(size, 0);
+		frontier.assign(size, 0);
+		next.assign(size, 0);
+		edgeFrontier.assign(size, 0);
+
+		for (unsigned row = 0; row < height; ++row) {
+			// vertical wall at col + 1 is the right side of cell col
+			const std::uint64_t * const leftWalls = maze.verticalWalls.rowWords(row);
+			std::uint64_t * const right = rowWords(openRight, row);
+			for (unsigned i = 0; i < stride - 2; ++i) {
+				const std::uint64_t carry = i + 1 < maze.verticalWalls.wordsPerRow ? leftWalls[i + 1] << 63 : 0;
+				right[i] = ~((leftWalls[i] >> 1) | carry) & columnMask(i, width - 1);
+			}
+
+			if (row + 1 < height) {
+				const std::uint64_t * const bottomWalls = maze.horizontalWalls.rowWords(row + 1);
+				std::uint64_t * const down = rowWords(openDown, row);
+				for (unsigned i = 0; i < stride - 2; ++i) {
+					down[i] = ~bottomWalls[i] & columnMask(i, width);
+				}
+			}
+		}
+	}
+
+	void solve(const Node & startNode)
+	{
+		solve(&startNode, &startNode + 1, static_cast<DistanceMap *>(nullptr));
+	}
+
+	// multi-source search, distances are written to map when it is not null
+	template <typename Distance>
+	void solve(const Node * firstSource, const Node * lastSource, BasicDistanceMap<Distance> * map)
+	{
+		clearRows(visited, 0, height);
+		clearRows(frontier, frontierFirst, frontierLast);
+		clearRows(edgeFrontier, edgeFirst, edgeLast);
+
+		if (map) {
+			map->reset(width, height);
+		}
+
+		frontierFirst = height;
+		frontierLast = 0;
+		for (const Node * source = firstSource; source != lastSource; ++source) {
+			rowWords(frontier, source->row)[source->col / 64] |= std::uint64_t(1) << (source->col % 64);
+			rowWords(visited, source->row)[source->col / 64] |= std::uint64_t(1) << (source->col % 64);
+			frontierFirst = std::min(frontierFirst, source->row);
+			frontierLast = std::max(frontierLast, source->row + 1);
+		}
+
+		unsigned distance = 0;
+		edgeDistance = 0;
+		hasEdgeFrontier = false;
+
+		for (;;) {
+			if (map) {
+				writeLayer(*map, Distance(distance));
+			}
+			if (touchesEdge()) {
+				edgeDistance = distance;
+				hasEdgeFrontier = true;
+				clearRows(edgeFrontier, edgeFirst, edgeLast);
+				copyRows(frontier, edgeFrontier, frontierFirst, frontierLast);
+				edgeFirst = frontierFirst;
+				edgeLast = frontierLast;
+			}
+
+			unsigned nextFirst = height;
+			unsigned nextLast = 0;
+			const unsigned first = frontierFirst > 0 ? frontierFirst - 1 : 0;
+			const unsigned last = std::min(frontierLast + 1, height);
+			for (unsigned row = first; row < last; ++row) {
+				if (expandRow(row)) {
+					nextFirst = std::min(nextFirst, row);
+					nextLast = row + 1;
+				}
+			}
+
+			if (nextFirst >= nextLast) {
+				break;
+			}
+
+			clearRows(frontier, frontierFirst, frontierLast);
+			std::swap(frontier, next);
+			frontierFirst = nextFirst;
+			frontierLast = nextLast;
+			++distance;
+		}
+
+		lastDistance = distance;
+	}
+
+	// distance of the farthest reachable cell from the sources of the last solve
+	unsigned eccentricity() const { return lastDistance; }
+
+	// same result as searchMaximums on the distance map of the last solve
+	std::vector<Node> maximums() const
+	{
+		std::vector<Node> ret;
+		for (unsigned row = frontierFirst; row < frontierLast; ++row) {
+			const std::uint64_t * const words = rowWords(frontier, row);
+			for (unsigned i = 0; i < stride - 2; ++i) {
+				for (std::uint64_t bits = words[i]; bits != 0; bits &= bits - 1) {
+					ret.push_back(Node(row, i * 64 + countTrailingZeros(bits)));
+				}
+			}
+		}
+		return ret;
+	}
+
+	// same result as searchMaximumsAtEdge on the distance map of the last solve
+	std::vector<unsigned> maximumsAtEdge() const
+	{
+		std::vector<unsigned> ret;
+		if (!hasEdgeFrontier) {
+			return ret;
+		}
+
+		unsigned index = 0;
+		const auto check = [&](const unsigned row, const unsigned col) {
+			if (isSet(edgeFrontier, row, col)) {
+				ret.push_back(index);
+			}
+			index++;
+		};
+
+		for (unsigned col = 0; col < width; col++) {
+			check(0, col);
+		}
+		for (unsigned row = 0; row < height; row++) {
+			check(row, width - 1);
+		}
+		for (unsigned col = width - 1; col < width; col--) {
+			check(height - 1, col);
+		}
+		for (unsigned row = height - 1; row < height; row--) {
+			check(row, 0);
+		}
+
+		return ret;
+	}
+
+	// distance of the farthest reachable border cell from the sources of the last solve
+	unsigned edgeEccentricity() const { return edgeDistance; }
+
+private:
+	// bits of word i that belong to columns below limit
+	static std::uint64_t columnMask(const unsigned i, const unsigned limit)
+	{
+		if (limit <= i * 64) {
+			return 0;
+		}
+		const unsigned bits = limit - i * 64;
+		return bits >= 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << bits) - 1;
+	}
+
+	std::uint64_t * rowWords(std::vector<std::uint64_t> & grid, const unsigned row)
+	{
+		return grid.data() + std::size_t(row + 1) * stride + 1;
+	}
+
+	const std::uint64_t * rowWords(const std::vector<std::uint64_t> & grid, const unsigned row) const
+	{
+		return grid.data() + std::size_t(row + 1) * stride + 1;
+	}
+
+	bool isSet(const std::vector<std::uint64_t> & grid, const unsigned row, const unsigned col) const
+	{
+		return (rowWords(grid, row)[col / 64] >> (col % 64)) & 1;
+	}
+
+	void clearRows(std::vector<std::uint64_t> & grid, const unsigned first, const unsigned last)
+	{
+		if (first < last) {
+			std::fill(rowWords(grid, first) - 1, rowWords(grid, last) - 1, 0);
+		}
+	}
+
+	void copyRows(const std::vector<std::uint64_t> & from, std::vector<std::uint64_t> & to, const unsigned first, const unsigned last)
+	{
+		std::copy(rowWords(from, first) - 1, rowWords(from, last) - 1, rowWords(to, first) - 1);
+	}
+
+	bool touchesEdge() const
+	{
+		if (frontierFirst == 0 || frontierLast == height) {
+			return true;
+		}
+		const unsigned lastWord = (width - 1) / 64;
+		const std::uint64_t lastBit = std::uint64_t(1) << ((width - 1) % 64);
+		for (unsigned row = frontierFirst; row < frontierLast; ++row) {
+			const std::uint64_t * const words = rowWords(frontier, row);
+			if ((words[0] & 1) || (words[lastWord] & lastBit)) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	template <typename Distance>
+	void writeLayer(BasicDistanceMap<Distance> & map, const Distance distance) const
+	{
+		for (unsigned row = frontierFirst; row < frontierLast; ++row) {
+			const std::uint64_t * const words = rowWords(frontier, row);
+			Distance * const values = map[row];
+			for (unsigned i = 0; i < stride - 2; ++i) {
+				for (std::uint64_t bits = words[i]; bits != 0; bits &= bits - 1) {
+					values[i * 64 + countTrailingZeros(bits)] = distance;
+				}
+			}
+		}
+	}
+
+	// computes the next frontier of one row, returns true when it is not empty
+	bool expandRow(const unsigned row)
+	{
+		const std::uint64_t * const above = rowWords(frontier, row) - stride;
+		const std::uint64_t * const current = rowWords(frontier, row);
+		const std::uint64_t * const below = rowWords(frontier, row) + stride;
+		const std::uint64_t * const right = rowWords(openRight, row);
+		const std::uint64_t * const downFromAbove = rowWords(openDown, row) - stride;
+		const std::uint64_t * const down = rowWords(openDown, row);
+		std::uint64_t * const seen = rowWords(visited, row);
+		std::uint64_t * const result = rowWords(next, row);
+
+		const unsigned words = stride - 2;
+		unsigned i = 0;
+		std::uint64_t any = 0;
+
+#if defined(__AVX2__)
+		__m256i anyLanes = _mm256_setzero_si256();
+		for (; i + 4 <= words; i += 4) {
+			const __m256i f = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(current + i));
+			const __m256i fPrev = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(current + i - 1));
+			const __m256i fNext = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(current + i + 1));
+			const __m256i r = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(right + i));
+			const __m256i rPrev = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(right + i - 1));
+
+			const __m256i toRight = _mm256_or_si256(
+				_mm256_slli_epi64(_mm256_and_si256(f, r), 1),
+				_mm256_srli_epi64(_mm256_and_si256(fPrev, rPrev), 63));
+			const __m256i toLeft = _mm256_and_si256(
+				_mm256_or_si256(_mm256_srli_epi64(f, 1), _mm256_slli_epi64(fNext, 63)), r);
+			const __m256i fromAbove = _mm256_and_si256(
+				_mm256_loadu_si256(reinterpret_cast<const __m256i *>(above + i)),
+				_mm256_loadu_si256(reinterpret_cast<const __m256i *>(downFromAbove + i)));
+			const __m256i fromBelow = _mm256_and_si256(
+				_mm256_loadu_si256(reinterpret_cast<const __m256i *>(below + i)),
+				_mm256_loadu_si256(reinterpret_cast<const __m256i *>(down + i)));
+
+			const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(seen + i));
+			const __m256i reached = _mm256_andnot_si256(s, _mm256_or_si256(
+				_mm256_or_si256(toRight, toLeft), _mm256_or_si256(fromAbove, fromBelow)));
+
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(result + i), reached);
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(seen + i), _mm256_or_si256(s, reached));
+			anyLanes = _mm256_or_si256(anyLanes, reached);
+		}
+		any = !_mm256_testz_si256(anyLanes, anyLanes);
+#endif
+
+		for (; i < words; ++i) {
+			const std::uint64_t toRight = ((current[i] & right[i]) << 1) | ((*(current + i - 1) & *(right + i - 1)) >> 63);
+			const std::uint64_t toLeft = ((current[i] >> 1) | (current[i + 1] << 63)) & right[i];
+			const std::uint64_t fromAbove = above[i] & downFromAbove[i];
+			const std::uint64_t fromBelow = below[i] & down[i];
+
+			const std::uint64_t reached = (toRight | toLeft | fromAbove | fromBelow) & ~seen[i];
+			result[i] = reached;
+			seen[i] |= reached;
+			any |= reached;
+		}
+
+		return any != 0;
+	}
+
+	unsigned width;
+	unsigned height;
+	unsigned stride;
+
+	std::vector<std::uint64_t> openRight; // cell can step to col + 1
+	std::vector<std::uint64_t> openDown; // cell can step to row + 1
+	std::vector<std::uint64_t> visited;
+	std::vector<std::uint64_t> frontier;
+	std::vector<std::uint64_t> next;
+	std::vector<std::uint64_t> edgeFrontier; // last frontier that reached the border
+
+	unsigned frontierFirst = 0; // rows [frontierFirst, frontierLast) may hold frontier bits
+	unsigned frontierLast = 0;
+	unsigned edgeFirst = 0;
+	unsigned edgeLast = 0;
+	unsigned lastDistance = 0;
+	unsigned edgeDistance = 0;
+	bool hasEdgeFrontier = false;
+};
+
+// Distance and path queries on one maze without a new search per query.
+// Cells that are on no loop are peeled off leaf by leaf, the parent of each points one step
+// towards the core of loops that is left. Two cells in the same peeled tree are joined by
+// their tree path, found through the lowest common ancestor of an Euler tour in constant
+// time. Any other route runs up both trees and through the core, which is contracted to its
+// junctions (core cells with more than two core neighbours) and the corridors between them.
+// There a query runs A* over the junctions, bounded below by the distances to 16 landmark
+// junctions, and only settles the junctions whose bound is below the route length. Junctions
+// grow with the loops, and generateArea has loops everywhere: a 1000x1000 maze has 152k of
+// them, and a query takes about 2 ms against 40 ms for a full search. The worst case stays
+// O(junctions log junctions). The index keeps about 28 bytes per cell and 76 bytes per
+// junction in memory, the file 1 byte per cell and 4 bytes per core cell.
+class PathIndex {
+public:
+	template <typename MazeType>
+	void build(const MazeType & maze)
+	{
+		width = maze.width;
+		height = maze.height;
+		const std::size_t cells = std::size_t(width) * height;
+
+		const auto neighbours = [&](const std::uint32_t cell, std::uint32_t (&next)[4]) {
+			const unsigned row = cell / width;
+			const unsigned col = cell % width;
+			unsigned count = 0;
+			if (maze.isOpenToTop(row, col)) {
+				next[count++] = cell - width;
+			}
+			if (maze.isOpenToBottom(row, col)) {
+				next[count++] = cell + width;
+			}
+			if (maze.isOpenToLeft(row, col)) {
+				next[count++] = cell - 1;
+			}
+			if (maze.isOpenToRight(row, col)) {
+				next[count++] = cell + 1;
+			}
+			return count;
+		};
+
+		// peel the leaves, degrees count the neighbours that are not peeled yet
+		std::uint32_t next[4];
+		std::vector<std::uint8_t> degrees(cells);
+		std::vector<std::uint32_t> leaves;
+		for (std::size_t cell = 0; cell < cells; ++cell) {
+			degrees[cell] = std::uint8_t(neighbours(std::uint32_t(cell), next));
+			if (degrees[cell] <= 1) {
+				leaves.push_back(std::uint32_t(cell));
+			}
+		}
+		std::vector<bool> peeled(cells, false);
+		parents.assign(cells, none);
+		for (std::size_t i = 0; i < leaves.size(); ++i) {
+			const std::uint32_t cell = leaves[i];
+			peeled[cell] = true;
+			for (unsigned k = neighbours(cell, next); k-- > 0;) {
+				if (!peeled[next[k]]) {
+					parents[cell] = next[k];
+					if (--degrees[next[k]] == 1) {
+						leaves.push_back(next[k]);
+					}
+				}
+			}
+		}
+
+		// the core neighbour of a corridor cell that is not previous
+		const auto onward = [&](const std::uint32_t cell, const std::uint32_t previous) {
+			std::uint32_t next[4];
+			for (unsigned k = neighbours(cell, next); k-- > 0;) {
+				if (!peeled[next[k]] && next[k] != previous) {
+					return next[k];
+				}
+			}
+			return none;
+		};
+
+		junctions.clear();
+		corridorEnds.clear();
+		corridorStart.assign(1, 0);
+		corridorCells.clear();
+		place.assign(cells, none);
+		const std::uint32_t walked = none - 1;
+		const auto walk = [&](const std::uint32_t junction, std::uint32_t cell) {
+			std::uint32_t previous = junction;
+			while (place[cell] == none) {
+				place[cell] = walked;
+				corridorCells.push_back(cell);
+				const std::uint32_t following = onward(cell, previous);
+				previous = cell;
+				cell = following;
+			}
+			corridorEnds.push_back(place[junction]);
+			corridorEnds.push_back(place[cell]);
+			corridorStart.push_back(std::uint32_t(corridorCells.size()));
+		};
+
+		// every corridor is walked once, from the first of its junctions that reaches it
+		for (std::size_t cell = 0; cell < cells; ++cell) {
+			if (!peeled[cell] && degrees[cell] != 2) {
+				place[cell] = std::uint32_t(junctions.size());
+				junctions.push_back(std::uint32_t(cell));
+			}
+		}
+		for (std::size_t i = 0; i < junctions.size(); ++i) {
+			const std::uint32_t junction = junctions[i];
+			for (unsigned k = neighbours(junction, next); k-- > 0;) {
+				if (!peeled[next[k]] && (place[next[k]] == none || (place[next[k]] != walked && junction < next[k]))) {
+					walk(junction, next[k]);
+				}
+			}
+		}
+		// loops without a junction get one at their first cell
+		for (std::size_t cell = 0; cell < cells; ++cell) {
+			if (!peeled[cell] && place[cell] == none) {
+				place[cell] = std::uint32_t(junctions.size());
+				junctions.push_back(std::uint32_t(cell));
+				walk(std::uint32_t(cell), onward(std::uint32_t(cell), none));
+			}
+		}
+
+		buildTour();
+		linkCore();
+		buildLandmarks();
+	}
+
+	// length of a shortest path, DistanceMap::unreachable() when b cannot be reached from a
+	std::uint32_t distance(const Node & a, const Node & b) const
+	{
+		const std::size_t from = indexOf(a);
+		const std::size_t to = indexOf(b);
+		if (roots[from] == roots[to]) {
+			return treeDistance(from, to);
+		}
+		const std::uint32_t core = coreRoute(roots[from], roots[to], nullptr);
+		return core == none ? DistanceMap::unreachable() : depths[from] + depths[to] + core;
+	}
+
+	// cells of a shortest path from a to b including both ends, empty when b cannot be reached
+	std::vector<Node> path(const Node & a, const Node & b) const
+	{
+		std::vector<Node> cells;
+		const std::uint32_t length = distance(a, b);
+		if (length == DistanceMap::unreachable()) {
+			return cells;
+		}
+
+		const std::uint32_t from = std::uint32_t(indexOf(a));
+		const std::uint32_t to = std::uint32_t(indexOf(b));
+		cells.reserve(length + 1);
+
+		// up to the common ancestor or the core, then down from the other end
+		const std::uint32_t top = roots[from] == roots[to] ? lowestCommonAncestor(from, to) : roots[from];
+		for (std::uint32_t cell = from; cell != top; cell = parents[cell]) {
+			cells.push_back(nodeOf(cell));
+		}
+		cells.push_back(nodeOf(top));
+		if (roots[from] != roots[to]) {
+			coreRoute(roots[from], roots[to], &cells);
+		}
+		const std::uint32_t bottom = roots[from] == roots[to] ? top : roots[to];
+		const std::size_t middle = cells.size();
+		for (std::uint32_t cell = to; cell != bottom; cell = parents[cell]) {
+			cells.push_back(nodeOf(cell));
+		}
+		std::reverse(cells.begin() + middle, cells.end());
+		return cells;
+	}
+
+	// Index file next to the maze file, little endian:
+	//   "MZPI", version, width, height, junction, corridor and corridor cell counts (7 x 32 bit)
+	//   parent of every cell (8 bit: none, top, bottom, left, right)
+	//   junction cells, both end junctions of every corridor, first corridor cell of every
+	//   corridor and one past the last, corridor cells in order (32 bit each)
+	// The tour, sparse table, junction links and landmarks are rebuilt when loading.
+	void save(const std::string & fileName) const
+	{
+		if (!isLittleEndian()) {
+			throw std::runtime_error("path indexes can only be written on little endian machines");
+		}
+
+		std::vector<std::uint8_t> directions(parents.size(), 0);
+		for (std::size_t cell = 0; cell < parents.size(); ++cell) {
+			if (parents[cell] != none) {
+				directions[cell] = parents[cell] + width == cell ? 1 : parents[cell] == cell + width ? 2 : parents[cell] + 1 == cell ? 3 : 4;
+			}
+		}
+
+		std::ofstream f(fileName, std::ios::binary);
+		const std::uint32_t header[] = { width, height, std::uint32_t(junctions.size()), std::uint32_t(corridorStart.size() - 1), std::uint32_t(corridorCells.size()) };
+		f.write("MZPI", 4);
+		writeValues(f, &pathIndexVersion, 1);
+		writeValues(f, header, 5);
+		writeValues(f, directions.data(), directions.size());
+		writeValues(f, junctions.data(), junctions.size());
+		writeValues(f, corridorEnds.data(), corridorEnds.size());
+		writeValues(f, corridorStart.data(), corridorStart.size());
+		writeValues(f, corridorCells.data(), corridorCells.size());
+		if (!f) {
+			throw std::runtime_error("cannot write " + fileName);
+		}
+		MAZE_COUNT(bytesWritten, f.tellp());
+	}
+
+	// throws when the file is not a consistent index, queries on a loaded index stay inside it
+	void load(const std::string & fileName)
+	{
+		std::ifstream f(fileName, std::ios::binary);
+		char magic[4] = {};
+		std::uint32_t version = 0;
+		std::uint32_t header[5] = {};
+		f.read(magic, 4);
+		readValues(f, &version, 1);
+		readValues(f, header, 5);
+		width = header[0];
+		height = header[1];
+		const std::uint64_t cells = std::uint64_t(width) * height;
+		const std::uint64_t fileSize = 28 + cells + 4 * (std::uint64_t(header[2]) + 3 * std::uint64_t(header[3]) + 1 + header[4]);
+		std::error_code error;
+		if (!f || !isLittleEndian() || std::memcmp(magic, "MZPI", 4) != 0 || version != pathIndexVersion
+			|| cells == 0 || cells >= none || header[2] > cells || header[3] > 2 * cells || header[4] > cells
+			|| std::filesystem::file_size(fileName, error) != fileSize) {
+			throw std::runtime_error(fileName + " is not a path index");
+		}
+
+		std::vector<std::uint8_t> directions(cells);
+		junctions.resize(header[2]);
+		corridorEnds.resize(2 * std::size_t(header[3]));
+		corridorStart.resize(std::size_t(header[3]) + 1);
+		corridorCells.resize(header[4]);
+		readValues(f, directions.data(), directions.size());
+		readValues(f, junctions.data(), junctions.size());
+		readValues(f, corridorEnds.data(), corridorEnds.size());
+		readValues(f, corridorStart.data(), corridorStart.size());
+		readValues(f, corridorCells.data(), corridorCells.size());
+		if (!f) {
+			throw std::runtime_error(fileName + " is truncated");
+		}
+
+		// parents have to be neighbours inside the maze and lead to a root without loops
+		bool valid = true;
+		parents.assign(cells, none);
+		for (std::size_t cell = 0; cell < cells && valid; ++cell) {
+			const unsigned row = unsigned(cell / width);
+			const unsigned col = unsigned(cell % width);
+			switch (directions[cell]) {
+			case 0: break;
+			case 1: valid = row > 0; parents[cell] = std::uint32_t(cell - width); break;
+			case 2: valid = row < height - 1; parents[cell] = std::uint32_t(cell + width); break;
+			case 3: valid = col > 0; parents[cell] = std::uint32_t(cell - 1); break;
+			case 4: valid = col < width - 1; parents[cell] = std::uint32_t(cell + 1); break;
+			default: valid = false;
+			}
+		}
+		if (!valid || !buildTour() || !linkCore()) {
+			throw std::runtime_error(fileName + " is not a path index");
+		}
+		buildLandmarks();
+	}
+
+	std::size_t junctionCount() const { return junctions.size(); }
+	std::size_t coreCellCount() const { return junctions.size() + corridorCells.size(); }
+
+private:
+	static constexpr std::uint32_t none = ~std::uint32_t(0);
+	static constexpr std::uint32_t pathIndexVersion = 2;
+	static constexpr std::size_t tourBlock = 64; // tour entries scanned without the sparse table
+	static constexpr unsigned maxLandmarks = 16;
+
+	Node nodeOf(const std::size_t cell) const { return Node(unsigned(cell / width), unsigned(cell % width)); }
+	std::size_t indexOf(const Node & n) const { return std::size_t(n.row) * width + n.col; }
+
+	bool adjacent(const std::uint32_t a, const std::uint32_t b) const
+	{
+		return (a / width == b / width && (a + 1 == b || b + 1 == a)) || a + width == b || b + width == a;
+	}
+
+	// Euler tour of every tree, a tree takes 2 * cells - 1 entries. False when some cells
+	// are not reached from a root, which only happens with parent loops in a corrupt file.
+	bool buildTour()
+	{
+		const std::size_t cells = parents.size();
+
+		// children of every cell, grouped by parent
+		std::vector<std::uint32_t> childStart(cells + 1, 0);
+		for (std::size_t cell = 0; cell < cells; ++cell) {
+			if (parents[cell] != none) {
+				++childStart[parents[cell] + 1];
+			}
+		}
+		for (std::size_t cell = 0; cell < cells; ++cell) {
+			childStart[cell + 1] += childStart[cell];
+		}
+		std::vector<std::uint32_t> children(childStart[cells]);
+		std::vector<std::uint32_t> filled(childStart.begin(), childStart.end() - 1);
+		for (std::size_t cell = 0; cell < cells; ++cell) {
+			if (parents[cell] != none) {
+				children[filled[parents[cell]]++] = std::uint32_t(cell);
+			}
+		}
+
+		depths.assign(cells, 0);
+		roots.assign(cells, none);
+		firstVisit.assign(cells, 0);
+		tour.clear();
+		tour.reserve(2 * cells);
+		// filled[cell] now walks through the children still to visit
+		std::copy(childStart.begin(), childStart.end() - 1, filled.begin());
+		std::vector<std::uint32_t> stack;
+		std::size_t reached = 0;
+		for (std::size_t root = 0; root < cells; ++root) {
+			if (parents[root] != none) {
+				continue;
+			}
+			roots[root] = std::uint32_t(root);
+			firstVisit[root] = std::uint32_t(tour.size());
+			tour.push_back(std::uint32_t(root));
+			stack.assign(1, std::uint32_t(root));
+			++reached;
+			while (!stack.empty()) {
+				const std::uint32_t cell = stack.back();
+				if (filled[cell] == childStart[cell + 1]) {
+					stack.pop_back();
+					if (!stack.empty()) {
+						tour.push_back(stack.back());
+					}
+					continue;
+				}
+				const std::uint32_t child = children[filled[cell]++];
+				depths[child] = depths[cell] + 1;
+				roots[child] = std::uint32_t(root);
+				firstVisit[child] = std::uint32_t(tour.size());
+				tour.push_back(child);
+				stack.push_back(child);
+				++reached;
+			}
+		}
+
+		buildSparseTable();
+		return reached == cells;
+	}
+
+	// sparse[level][i] is the shallowest entry of the tour blocks [i, i + 2^level)
+	void buildSparseTable()
+	{
+		std::vector<std::uint32_t> blocks((tour.size() + tourBlock - 1) / tourBlock);
+		for (std::size_t i = 0; i < tour.size(); ++i) {
+			blocks[i / tourBlock] = i % tourBlock == 0 ? tour[i] : shallower(blocks[i / tourBlock], tour[i]);
+		}
+		sparse.assign(1, std::move(blocks));
+		for (std::size_t span = 2; span <= sparse[0].size(); span *= 2) {
+			const std::vector<std::uint32_t> & previous = sparse.back();
+			std::vector<std::uint32_t> level(sparse[0].size() - span + 1);
+			for (std::size_t i = 0; i < level.size(); ++i) {
+				level[i] = shallower(previous[i], previous[i + span / 2]);
+			}
+			sparse.push_back(std::move(level));
+		}
+	}
+
+	std::uint32_t shallower(const std::uint32_t a, const std::uint32_t b) const
+	{
+		return depths[b] < depths[a] ? b : a;
+	}
+
+	// the ends of the range are scanned, the whole blocks between come from the sparse table
+	std::uint32_t lowestCommonAncestor(const std::size_t a, const std::size_t b) const
+	{
+		const std::size_t first = std::min(firstVisit[a], firstVisit[b]);
+		const std::size_t last = std::max(firstVisit[a], firstVisit[b]);
+		const std::size_t firstBlock = first / tourBlock + 1;
+		const std::size_t lastBlock = last / tourBlock;
+
+		std::uint32_t ancestor = tour[first];
+		if (firstBlock >= lastBlock) {
+			for (std::size_t i = first + 1; i <= last; ++i) {
+				ancestor = shallower(ancestor, tour[i]);
+			}
+			return ancestor;
+		}
+		for (std::size_t i = first + 1; i < firstBlock * tourBlock; ++i) {
+			ancestor = shallower(ancestor, tour[i]);
+		}
+		for (std::size_t i = lastBlock * tourBlock; i <= last; ++i) {
+			ancestor = shallower(ancestor, tour[i]);
+		}
+		unsigned level = 0;
+		while ((std::size_t(2) << level) <= lastBlock - firstBlock) {
+			++level;
+		}
+		ancestor = shallower(ancestor, sparse[level][firstBlock]);
+		return shallower(ancestor, sparse[level][lastBlock - (std::size_t(1) << level)]);
+	}
+
+	std::uint32_t treeDistance(const std::size_t a, const std::size_t b) const
+	{
+		return depths[a] + depths[b] - 2 * depths[lowestCommonAncestor(a, b)];
+	}
+
+	// Places of the core cells, the corridors of every junction and the connected part of
+	// every junction. False when the core is inconsistent, which only a corrupt file can be.
+	bool linkCore()
+	{
+		const std::size_t cells = parents.size();
+		const std::size_t corridors = corridorStart.size() - 1;
+		place.assign(cells, none);
+		const auto claim = [&](const std::uint32_t cell, const std::size_t value) {
+			if (cell >= cells || place[cell] != none || parents[cell] != none) {
+				return false;
+			}
+			place[cell] = std::uint32_t(value);
+			return true;
+		};
+		for (std::size_t i = 0; i < junctions.size(); ++i) {
+			if (!claim(junctions[i], i)) {
+				return false;
+			}
+		}
+		for (std::size_t i = 0; i < corridorCells.size(); ++i) {
+			if (!claim(corridorCells[i], junctions.size() + i)) {
+				return false;
+			}
+		}
+		if (corridorStart[0] != 0 || corridorStart[corridors] != corridorCells.size()
+			|| !std::is_sorted(corridorStart.begin(), corridorStart.end())) {
+			return false;
+		}
+		for (std::size_t corridor = 0; corridor < corridors; ++corridor) {
+			if (corridorEnds[2 * corridor] >= junctions.size() || corridorEnds[2 * corridor + 1] >= junctions.size()) {
+				return false;
+			}
+			for (std::uint32_t offset = 0; offset < corridorLength(corridor); ++offset) {
+				if (!adjacent(corridorCell(corridor, offset), corridorCell(corridor, offset + 1))) {
+					return false;
+				}
+			}
+		}
+
+		junctionStart.assign(junctions.size() + 1, 0);
+		for (const std::uint32_t junction : corridorEnds) {
+			++junctionStart[junction + 1];
+		}
+		for (std::size_t i = 0; i < junctions.size(); ++i) {
+			junctionStart[i + 1] += junctionStart[i];
+		}
+		junctionCorridors.resize(corridorEnds.size());
+		std::vector<std::uint32_t> filled(junctionStart.begin(), junctionStart.end() - 1);
+		for (std::size_t i = 0; i < corridorEnds.size(); ++i) {
+			junctionCorridors[filled[corridorEnds[i]]++] = std::uint32_t(i / 2);
+		}
+
+		// union find over the corridors, every junction ends up pointing at its part
+		junctionParts.resize(junctions.size());
+		for (std::size_t i = 0; i < junctions.size(); ++i) {
+			junctionParts[i] = std::uint32_t(i);
+		}
+		const auto find = [&](std::uint32_t junction) {
+			while (junctionParts[junction] != junction) {
+				junctionParts[junction] = junctionParts[junctionParts[junction]];
+				junction = junctionParts[junction];
+			}
+			return junction;
+		};
+		for (std::size_t corridor = 0; corridor < corridors; ++corridor) {
+			junctionParts[find(corridorEnds[2 * corridor + 1])] = find(corridorEnds[2 * corridor]);
+		}
+		for (std::size_t i = 0; i < junctions.size(); ++i) {
+			junctionParts[i] = find(std::uint32_t(i));
+		}
+		return true;
+	}
+
+	// Landmarks for the lower bounds of coreRoute: the junction farthest from all landmarks so
+	// far, starting in the part with the most junctions. Also sizes the query scratch.
+	void buildLandmarks()
+	{
+		const std::size_t count = junctions.size();
+		distances.assign(count, none);
+		arrival.assign(count, none);
+		stamps.assign(count, 0);
+		generation = 0;
+		route.clear();
+		landmarkCount = unsigned(std::min<std::size_t>(maxLandmarks, count));
+		landmarkDistances.assign(count * landmarkCount, none);
+		if (count == 0) {
+			return;
+		}
+
+		std::vector<std::uint32_t> partSizes(count, 0);
+		for (const std::uint32_t part : junctionParts) {
+			++partSizes[part];
+		}
+		std::uint32_t landmark = std::uint32_t(std::max_element(partSizes.begin(), partSizes.end()) - partSizes.begin());
+
+		// the first landmark is the junction farthest from the start, each search also picks the next
+		std::vector<std::uint32_t> nearest(count, none);
+		std::vector<std::uint32_t> found;
+		for (unsigned i = 0; i <= landmarkCount; ++i) {
+			junctionDistances(landmark, found);
+			if (i > 0) {
+				for (std::size_t junction = 0; junction < count; ++junction) {
+					landmarkDistances[junction * landmarkCount + i - 1] = found[junction];
+					nearest[junction] = std::min(nearest[junction], found[junction]);
+				}
+			}
+			else {
+				nearest = found;
+			}
+			for (std::size_t junction = 0; junction < count; ++junction) {
+				if (nearest[junction] != none && nearest[junction] >= nearest[landmark]) {
+					landmark = std::uint32_t(junction);
+				}
+			}
+		}
+	}
+
+	// Dijkstra over the corridors from one junction
+	void junctionDistances(const std::uint32_t source, std::vector<std::uint32_t> & found) const
+	{
+		typedef std::pair<std::uint32_t, std::uint32_t> Entry; // length, junction
+		std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+		found.assign(junctions.size(), none);
+		found[source] = 0;
+		queue.push(Entry(0, source));
+		while (!queue.empty()) {
+			const Entry entry = queue.top();
+			queue.pop();
+			if (entry.first != found[entry.second]) {
+				continue;
+			}
+			for (std::uint32_t i = junctionStart[entry.second]; i < junctionStart[entry.second + 1]; ++i) {
+				const std::uint32_t corridor = junctionCorridors[i];
+				const std::uint32_t neighbour = otherEnd(corridor, entry.second);
+				const std::uint32_t length = entry.first + corridorLength(corridor);
+				if (length < found[neighbour]) {
+					found[neighbour] = length;
+					queue.push(Entry(length, neighbour));
+				}
+			}
+		}
+	}
+
+	void nextGeneration() const
+	{
+		if (++generation == 0) {
+			std::fill(stamps.begin(), stamps.end(), 0);
+			generation = 1;
+		}
+	}
+
+	std::uint32_t corridorLength(const std::size_t corridor) const
+	{
+		return corridorStart[corridor + 1] - corridorStart[corridor] + 1;
+	}
+
+	// offset 0 is the first end junction, corridorLength the second
+	std::uint32_t corridorCell(const std::size_t corridor, const std::uint32_t offset) const
+	{
+		if (offset == 0) {
+			return junctions[corridorEnds[2 * corridor]];
+		}
+		if (offset == corridorLength(corridor)) {
+			return junctions[corridorEnds[2 * corridor + 1]];
+		}
+		return corridorCells[corridorStart[corridor] + offset - 1];
+	}
+
+	std::uint32_t otherEnd(const std::size_t corridor, const std::uint32_t junction) const
+	{
+		return corridorEnds[2 * corridor] == junction ? corridorEnds[2 * corridor + 1] : corridorEnds[2 * corridor];
+	}
+
+	// appends the corridor cells after from up to and including to
+	void appendCorridor(const std::size_t corridor, std::uint32_t from, const std::uint32_t to, std::vector<Node> & cells) const
+	{
+		while (from != to) {
+			from = from < to ? from + 1 : from - 1;
+			cells.push_back(nodeOf(corridorCell(corridor, from)));
+		}
+	}
+
+	// A core cell is a junction, or lies on a corridor at an offset from its first end.
+	struct CorePlace {
+		std::uint32_t junction; // none on a corridor
+		std::uint32_t corridor;
+		std::uint32_t offset;
+	};
+
+	CorePlace corePlace(const std::uint32_t cell) const
+	{
+		if (place[cell] < junctions.size()) {
+			return { place[cell], none, 0 };
+		}
+		const std::uint32_t position = place[cell] - std::uint32_t(junctions.size());
+		const std::uint32_t corridor = std::uint32_t(std::upper_bound(corridorStart.begin(), corridorStart.end(), position) - corridorStart.begin() - 1);
+		return { none, corridor, position - corridorStart[corridor] + 1 };
+	}
+
+	// Shortest route between two core cells, none when they are not connected or one of them
+	// roots a tree without loops. With cells, appends the route after s up to and including t.
+	std::uint32_t coreRoute(const std::uint32_t s, const std::uint32_t t, std::vector<Node> * cells) const
+	{
+		if (place[s] == none || place[t] == none) {
+			return none;
+		}
+		const CorePlace source = corePlace(s);
+		const CorePlace target = corePlace(t);
+		const auto part = [&](const CorePlace & p) {
+			return junctionParts[p.junction != none ? p.junction : corridorEnds[2 * p.corridor]];
+		};
+		if (part(source) != part(target)) {
+			return none;
+		}
+
+		// the junctions next to a cell and their distances
+		const auto ends = [&](const CorePlace & p, std::uint32_t (&junction)[2], std::uint32_t (&length)[2]) {
+			if (p.junction != none) {
+				junction[0] = p.junction;
+				length[0] = 0;
+				return 1u;
+			}
+			junction[0] = corridorEnds[2 * p.corridor];
+			length[0] = p.offset;
+			junction[1] = corridorEnds[2 * p.corridor + 1];
+			length[1] = corridorLength(p.corridor) - p.offset;
+			return 2u;
+		};
+		std::uint32_t sourceEnds[2];
+		std::uint32_t sourceLengths[2];
+		std::uint32_t targetEnds[2];
+		std::uint32_t targetLengths[2];
+		const unsigned sourceCount = ends(source, sourceEnds, sourceLengths);
+		const unsigned targetCount = ends(target, targetEnds, targetLengths);
+
+		std::uint32_t best = none;
+		std::uint32_t bestJunction = none; // none for the direct way along one corridor
+		unsigned bestEnd = 0;
+		if (source.junction == none && source.corridor == target.corridor) {
+			best = source.offset < target.offset ? target.offset - source.offset : source.offset - target.offset;
+		}
+
+		// A* over the junctions. No route to t is shorter than the grid distance, or than the
+		// difference of the distances of both ends to a landmark.
+		const Node goal = nodeOf(t);
+		std::uint32_t goalDistances[maxLandmarks];
+		for (unsigned landmark = 0; landmark < landmarkCount; ++landmark) {
+			goalDistances[landmark] = none;
+			for (unsigned end = 0; end < targetCount; ++end) {
+				const std::uint32_t distance = landmarkDistances[std::size_t(targetEnds[end]) * landmarkCount + landmark];
+				if (distance != none) {
+					goalDistances[landmark] = std::min(goalDistances[landmark], distance + targetLengths[end]);
+				}
+			}
+		}
+		const auto estimate = [&](const std::uint32_t junction) {
+			const Node n = nodeOf(junctions[junction]);
+			std::uint32_t bound = (n.row < goal.row ? goal.row - n.row : n.row - goal.row) + (n.col < goal.col ? goal.col - n.col : n.col - goal.col);
+			const std::uint32_t * distances = &landmarkDistances[std::size_t(junction) * landmarkCount];
+			for (unsigned landmark = 0; landmark < landmarkCount; ++landmark) {
+				if (distances[landmark] != none && goalDistances[landmark] != none) {
+					bound = std::max(bound, distances[landmark] < goalDistances[landmark] ? goalDistances[landmark] - distances[landmark] : distances[landmark] - goalDistances[landmark]);
+				}
+			}
+			return bound;
+		};
+
+		// arrival is the corridor a junction was reached through, or none - 1 - end for the
+		// end of the source corridor it starts from
+		nextGeneration();
+		const auto reached = [&](const std::uint32_t junction) {
+			return stamps[junction] == generation ? distances[junction] : none;
+		};
+		const auto reach = [&](const std::uint32_t junction, const std::uint32_t length, const std::uint32_t from) {
+			stamps[junction] = generation;
+			distances[junction] = length;
+			arrival[junction] = from;
+			heap.push_back(HeapEntry{ length + estimate(junction), length, junction });
+			std::push_heap(heap.begin(), heap.end());
+		};
+		heap.clear();
+		for (unsigned end = 0; end < sourceCount; ++end) {
+			if (sourceLengths[end] < reached(sourceEnds[end])) {
+				reach(sourceEnds[end], sourceLengths[end], none - 1 - end);
+			}
+		}
+		while (!heap.empty() && heap.front().bound < best) {
+			const HeapEntry entry = heap.front();
+			std::pop_heap(heap.begin(), heap.end());
+			heap.pop_back();
+			const std::uint32_t junction = entry.junction;
+			if (entry.length != distances[junction]) {
+				continue;
+			}
+			for (unsigned end = 0; end < targetCount; ++end) {
+				if (targetEnds[end] == junction && entry.length + targetLengths[end] < best) {
+					best = entry.length + targetLengths[end];
+					bestJunction = junction;
+					bestEnd = end;
+				}
+			}
+			for (std::uint32_t i = junctionStart[junction]; i < junctionStart[junction + 1]; ++i) {
+				const std::uint32_t corridor = junctionCorridors[i];
+				const std::uint32_t neighbour = otherEnd(corridor, junction);
+				const std::uint32_t length = entry.length + corridorLength(corridor);
+				if (length < reached(neighbour)) {
+					reach(neighbour, length, corridor);
+				}
+			}
+		}
+
+		if (cells) {
+			if (bestJunction == none) {
+				appendCorridor(source.corridor, source.offset, target.offset, *cells);
+				return best;
+			}
+
+			std::vector<std::uint32_t> & corridors = route;
+			corridors.clear();
+			std::uint32_t junction = bestJunction;
+			while (arrival[junction] < corridorStart.size() - 1) {
+				corridors.push_back(arrival[junction]);
+				junction = otherEnd(arrival[junction], junction);
+			}
+			if (source.junction == none) {
+				appendCorridor(source.corridor, source.offset, arrival[junction] == none - 1 ? 0 : corridorLength(source.corridor), *cells);
+			}
+			for (std::size_t i = corridors.size(); i-- > 0;) {
+				const std::size_t corridor = corridors[i];
+				const bool forward = corridorEnds[2 * corridor] == junction;
+				appendCorridor(corridor, forward ? 0 : corridorLength(corridor), forward ? corridorLength(corridor) : 0, *cells);
+				junction = otherEnd(corridor, junction);
+			}
+			if (target.junction == none) {
+				appendCorridor(target.corridor, bestEnd == 0 ? 0 : corridorLength(target.corridor), target.offset, *cells);
+			}
+		}
+		return best;
+	}
+
+	template <typename T>
+	static void writeValues(std::ofstream & f, const T * values, const std::size_t count)
+	{
+		f.write(reinterpret_cast<const char *>(values), count * sizeof(T));
+	}
+
+	template <typename T>
+	static void readValues(std::ifstream & f, T * values, const std::size_t count)
+	{
+		f.read(reinterpret_cast<char *>(values), count * sizeof(T));
+	}
+
+	unsigned width = 0;
+	unsigned height = 0;
+	std::vector<std::uint32_t> parents; // one step towards the core, none for roots
+	std::vector<std::uint32_t> depths; // distance to the root of the tree
+	std::vector<std::uint32_t> roots; // a core cell, or the root of a part without loops
+	std::vector<std::uint32_t> firstVisit; // first tour position of every cell
+	std::vector<std::uint32_t> tour;
+	std::vector<std::vector<std::uint32_t>> sparse;
+	std::vector<std::uint32_t> junctions; // cells
+	std::vector<std::uint32_t> corridorEnds; // two junctions per corridor
+	std::vector<std::uint32_t> corridorStart; // first corridor cell of every corridor, one more entry
+	std::vector<std::uint32_t> corridorCells; // cells between the ends, in order from the first end
+	std::vector<std::uint32_t> place; // junction, or junctions.size() + corridor cell position, none off the core
+	std::vector<std::uint32_t> junctionStart; // corridors of every junction
+	std::vector<std::uint32_t> junctionCorridors;
+	std::vector<std::uint32_t> junctionParts; // connected part of every junction
+	unsigned landmarkCount = 0;
+	std::vector<std::uint32_t> landmarkDistances; // landmarkCount per junction, none when unreachable
+
+	// Query scratch, sized once per index. A junction's distance and arrival are only valid
+	// while its stamp is the current generation, so a query does not clear them. Queries on
+	// one index are therefore not thread safe.
+	struct HeapEntry {
+		std::uint32_t bound; // length plus the estimate of the rest
+		std::uint32_t length;
+		std::uint32_t junction;
+
+		bool operator<(const HeapEntry & other) const { return bound > other.bound; } // smallest bound on top
+	};
+	mutable std::vector<std::uint32_t> distances;
+	mutable std::vector<std::uint32_t> arrival;
+	mutable std::vector<std::uint32_t> stamps;
+	mutable std::uint32_t generation = 0;
+	mutable std::vector<HeapEntry> heap;
+	mutable std::vector<std::uint32_t> route;
+};
+
+// Entry and exit distance maps of a maze that is edited one wall at a time.
+// Every edit repairs only the cells whose distance changes: opening a wall spreads the
+// shorter distances from the wall with a breadth first search that stops where nothing
+// improves. Closing a wall first collects the cells that lost their last shortest path,
+// level by level from the far side of the wall, and then fills them in again from their
+// unaffected neighbours. maze.visualizedDMap is kept as the minimum of both maps.
+class IncrementalDistances {
+public:
+	void build(Maze & maze, BfsWorkspace & workspace)
+	{
+		workspace.run(maze, maze.entryNode, entryMap);
+		workspace.run(maze, maze.exitNode, exitMap);
+		maze.visualizedDMap.reset(maze.width, maze.height);
+		for (std::size_t cell = 0; cell < entryMap.cells.size(); ++cell) {
+			maze.visualizedDMap.cells[cell] = std::min(entryMap.cells[cell], exitMap.cells[cell]);
+		}
+		marks.assign(entryMap.cells.size(), 0);
+		edit = 0;
+	}
+
+	// sets one wall, addressed like Maze::openWall, and repairs the distance maps
+	void setWall(Maze & maze, const Orientation orientation, const unsigned line, const unsigned element, const bool closed)
+	{
+		Node a;
+		Node b;
+		if (orientation == Orientation::Horizontal) {
+			if (maze.hasHorizontalWall(line, element) == closed) {
+				return;
+			}
+			maze.setHorizontalWall(line, element, closed);
+			if (line == 0 || line == maze.height) {
+				return; // the outer border is never part of a path
+			}
+			a = Node(line - 1, element);
+			b = Node(line, element);
+		}
+		else {
+			if (maze.hasVerticalWall(element, line) == closed) {
+				return;
+			}
+			maze.setVerticalWall(element, line, closed);
+			if (line == 0 || line == maze.width) {
+				return;
+			}
+			a = Node(element, line - 1);
+			b = Node(element, line);
+		}
+
+		changed.clear();
+		for (DistanceMap * map : { &entryMap, &exitMap }) {
+			if (closed) {
+				repairClosed(maze, *map, a, b);
+			}
+			else {
+				repairOpened(maze, *map, a, b);
+			}
+		}
+		for (const Node & n : changed) {
+			maze.visualizedDMap[n.row][n.col] = std::min(entryMap[n.row][n.col], exitMap[n.row][n.col]);
+		}
+	}
+
+	const DistanceMap & entryDistances() const { return entryMap; }
+	const DistanceMap & exitDistances() const { return exitMap; }
+
+private:
+	template <typename Visit>
+	static void forEachNeighbour(const Maze & maze, const Node & n, const Visit & visit)
+	{
+		if (maze.isOpenToTop(n.row, n.col)) {
+			visit(Node(n.row - 1, n.col));
+		}
+		if (maze.isOpenToBottom(n.row, n.col)) {
+			visit(Node(n.row + 1, n.col));
+		}
+		if (maze.isOpenToLeft(n.row, n.col)) {
+			visit(Node(n.row, n.col - 1));
+		}
+		if (maze.isOpenToRight(n.row, n.col)) {
+			visit(Node(n.row, n.col + 1));
+		}
+	}
+
+	void repairOpened(const Maze & maze, DistanceMap & map, const Node & a, const Node & b)
+	{
+		queue.clear();
+		const auto relax = [&](const Node & from, const Node & to) {
+			const std::uint32_t distance = map[from.row][from.col];
+			if (distance != map.unreachable() && distance + 1 < map[to.row][to.col]) {
+				map[to.row][to.col] = distance + 1;
+				queue.push_back(to);
+			}
+		};
+
+		// at most one side gets closer, from there the search only runs while distances drop
+		relax(a, b);
+		relax(b, a);
+		for (std::size_t head = 0; head < queue.size(); ++head) {
+			const Node n = queue[head];
+			changed.push_back(n);
+			forEachNeighbour(maze, n, [&](const Node & next) { relax(n, next); });
+		}
+	}
+
+	void repairClosed(const Maze & maze, DistanceMap & map, const Node & a, const Node & b)
+	{
+		const std::uint32_t distanceA = map[a.row][a.col];
+		const std::uint32_t distanceB = map[b.row][b.col];
+		if (distanceA == distanceB) {
+			return; // no shortest path used the passage, or both sides are unreachable
+		}
+
+		// marks of this repair: checked and still supported, or affected
+		++edit;
+		const std::uint32_t supportedMark = 2 * edit;
+		const std::uint32_t affectedMark = 2 * edit + 1;
+		const auto mark = [&](const Node & n) -> std::uint32_t & { return marks[std::size_t(n.row) * maze.width + n.col]; };
+
+		// a cell is affected when no unaffected neighbour is one step closer; levels are
+		// checked in increasing order, so the cells one step closer are settled already
+		affected.clear();
+		queue.assign(1, distanceA < distanceB ? b : a);
+		for (std::size_t head = 0; head < queue.size(); ++head) {
+			const Node n = queue[head];
+			if (mark(n) >= supportedMark) {
+				continue;
+			}
+			const std::uint32_t distance = map[n.row][n.col];
+			bool supported = false;
+			forEachNeighbour(maze, n, [&](const Node & next) {
+				supported = supported || (map[next.row][next.col] + 1 == distance && mark(next) != affectedMark);
+			});
+			if (supported) {
+				mark(n) = supportedMark;
+				continue;
+			}
+			mark(n) = affectedMark;
+			affected.push_back(n);
+			forEachNeighbour(maze, n, [&](const Node & next) {
+				if (map[next.row][next.col] == distance + 1) {
+					queue.push_back(next);
+				}
+			});
+		}
+
+		for (const Node & n : affected) {
+			map[n.row][n.col] = map.unreachable();
+			changed.push_back(n);
+		}
+
+		// every affected cell restarts from its best unaffected neighbour, and the seeds
+		// merged with the search queue in distance order keep the search breadth first
+		seeds.clear();
+		for (const Node & n : affected) {
+			std::uint32_t best = map.unreachable();
+			forEachNeighbour(maze, n, [&](const Node & next) {
+				if (map[next.row][next.col] != map.unreachable()) {
+					best = std::min(best, map[next.row][next.col] + 1);
+				}
+			});
+			if (best != map.unreachable()) {
+				seeds.push_back({ n, best });
+			}
+		}
+		std::sort(seeds.begin(), seeds.end(), [](const Seed & x, const Seed & y) { return x.distance < y.distance; });
+
+		queue.clear();
+		std::size_t seed = 0;
+		std::size_t head = 0;
+		while (seed < seeds.size() || head < queue.size()) {
+			Node n;
+			if (seed == seeds.size() || (head < queue.size() && map[queue[head].row][queue[head].col] <= seeds[seed].distance)) {
+				n = queue[head++];
+			}
+			else {
+				const Seed & s = seeds[seed++];
+				if (s.distance >= map[s.node.row][s.node.col]) {
+					continue;
+				}
+				n = s.node;
+				map[n.row][n.col] = s.distance;
+			}
+			const std::uint32_t distance = map[n.row][n.col] + 1;
+			forEachNeighbour(maze, n, [&](const Node & next) {
+				if (distance < map[next.row][next.col]) {
+					map[next.row][next.col] = distance;
+					queue.push_back(next);
+				}
+			});
+		}
+	}
+
+	struct Seed {
+		Node node;
+		std::uint32_t distance;
+	};
+
+	DistanceMap entryMap;
+	DistanceMap exitMap;
+	std::vector<std::uint32_t> marks; // per cell, see repairClosed
+	std::uint32_t edit = 0;
+	std::vector<Node> queue;
+	std::vector<Node> affected;
+	std::vector<Node> changed;
+	std::vector<Seed> seeds;
+};
+
+inline std::uint64_t splitMix64(std::uint64_t & state)
+{
+	std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+inline std::mt19937 seededRandom(const std::uint64_t seed)
+{
+	std::seed_seq seq{ std::uint32_t(seed), std::uint32_t(seed >> 32) };
+	return std::mt19937(seq);
+}
+
+// Engines for the generator besides std::mt19937. All of them produce every value of their
+// result type, which boundedRandom relies on, and are seeded from a single 64 bit seed.
+
+// xoshiro256** by Blackman and Vigna, its state is filled with splitMix64 as they recommend
+class Xoshiro256 {
+public:
+	using result_type = std::uint64_t;
+
+	explicit Xoshiro256(std::uint64_t seed)
+	{
+		for (std::uint64_t & word : state) {
+			word = splitMix64(seed);
+		}
+	}
+
+	static constexpr result_type min() { return 0; }
+	static constexpr result_type max() { return ~result_type(0); }
+
+	result_type operator()()
+	{
+		const std::uint64_t result = rotateLeft(state[1] * 5, 7) * 9;
+		const std::uint64_t shifted = state[1] << 17;
+		state[2] ^= state[0];
+		state[3] ^= state[1];
+		state[1] ^= state[2];
+		state[0] ^= state[3];
+		state[2] ^= shifted;
+		state[3] = rotateLeft(state[3], 45);
+		return result;
+	}
+
+private:
+	static std::uint64_t rotateLeft(const std::uint64_t value, const unsigned bits)
+	{
+		return (value << bits) | (value >> (64 - bits));
+	}
+
+	std::uint64_t state[4];
+};
+
+// PCG32 (XSH RR) by O'Neill, the stream is picked from the seed as well
+class Pcg32 {
+public:
+	using result_type = std::uint32_t;
+
+	explicit Pcg32(std::uint64_t seed) : state(0)
+	{
+		const std::uint64_t initial = splitMix64(seed);
+		increment = (splitMix64(seed) << 1) | 1;
+		(*this)();
+		state += initial;
+		(*this)();
+	}
+
+	static constexpr result_type min() { return 0; }
+	static constexpr result_type max() { return ~result_type(0); }
+
+	result_type operator()()
+	{
+		const std::uint64_t previous = state;
+		state = previous * 6364136223846793005ull + increment;
+		const std::uint32_t shuffled = std::uint32_t(((previous >> 18) ^ previous) >> 27);
+		const unsigned rotation = unsigned(previous >> 59);
+		return (shuffled >> rotation) | (shuffled << ((32 - rotation) & 31));
+	}
+
+private:
+	std::uint64_t state;
+	std::uint64_t increment;
+};
+
+// Counter based engine: the n-th number only depends on the seed and n, it is the splitMix64
+// output for that position. seek jumps anywhere in the stream, so a part of a maze can be
+// regenerated from its position without replaying everything before it.
+class CounterRandom {
+public:
+	using result_type = std::uint64_t;
+
+	explicit CounterRandom(const std::uint64_t seed) : key(seed), counter(0) {}
+
+	static constexpr result_type min() { return 0; }
+	static constexpr result_type max() { return ~result_type(0); }
+
+	result_type operator()()
+	{
+		std::uint64_t state = key + counter++ * 0x9E3779B97F4A7C15ull;
+		return splitMix64(state);
+	}
+
+	void seek(const std::uint64_t position) { counter = position; }
+	std::uint64_t position() const { return counter; }
+
+private:
+	const std::uint64_t key;
+	std::uint64_t counter;
+};
+
+// the upper 32 bits of the next number, the better ones for xoshiro
+template <typename Engine>
+std::uint32_t random32(Engine & engine)
+{
+	const auto value = engine();
+	return sizeof(value) > 4 ? std::uint32_t(std::uint64_t(value) >> 32) : std::uint32_t(value);
+}
+
+// Uniform integer from [0, range) after Lemire, "Fast Random Integer Generation in an
+// Interval": the high half of a 32 x 32 bit product, with a division only in the rare case
+// that the low half falls into the biased part, where the draw is repeated.
+template <typename Engine>
+std::uint32_t boundedRandom(Engine & engine, const std::uint32_t range)
+{
+	std::uint64_t product = std::uint64_t(random32(engine)) * range;
+	if (std::uint32_t(product) < range) {
+		const std::uint32_t threshold = (0u - range) % range;
+		while (std::uint32_t(product) < threshold) {
+			product = std::uint64_t(random32(engine)) * range;
+		}
+	}
+	return std::uint32_t(product >> 32);
+}
+
+// uniform index from [0, count)
+template <typename Engine>
+unsigned randomIndex(Engine & engine, const unsigned count)
+{
+	return boundedRandom(engine, count);
+}
+
+// std::mt19937 keeps the std distribution, so seeds give the same mazes as before
+inline unsigned randomIndex(std::mt19937 & engine, const unsigned count)
+{
+	std::uniform_int_distribution<> dis(0, count - 1);
+	return dis(engine);
+}
+
+// Work stealing thread pool.
+// Every worker owns a task deque: it pushes and pops its own tasks at the back (depth
+// first, good locality for recursive work) while idle workers steal from the front of
+// the others, which hands them the oldest and usually largest pieces of work.
+class TaskPool {
+public:
+	explicit TaskPool(unsigned threadCount = 0)
+	{
+		if (threadCount == 0) {
+			threadCount = std::max(1u, std::thread::hardware_concurrency());
+		}
+		for (unsigned i = 0; i < threadCount; ++i) {
+			queues.emplace_back(new TaskQueue());
+		}
+		for (unsigned i = 0; i < threadCount; ++i) {
+			threads.emplace_back([this, i] { workerLoop(i); });
+		}
+	}
+
+	~TaskPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(sleepMutex);
+			stopping = true;
+		}
+		wake.notify_all();
+		for (std::thread & thread : threads) {
+			thread.join();
+		}
+	}
+
+	TaskPool(const TaskPool &) = delete;
+	TaskPool & operator=(const TaskPool &) = delete;
+
+	unsigned size() const { return unsigned(threads.size()); }
+
+	// can be called from inside a running task as well
+	void submit(std::function<void()> task)
+	{
+		pending.fetch_add(1);
+		const unsigned target = currentPool == this ? currentWorker : unsigned(nextQueue.fetch_add(1) % queues.size());
+		{
+			std::lock_guard<std::mutex> lock(queues[target]->mutex);
+			queues[target]->tasks.push_back(std::move(task));
+		}
+		{
+			std::lock_guard<std::mutex> lock(sleepMutex);
+			++queued;
+		}
+		wake.notify_one();
+	}
+
+	// blocks until every submitted task, including the ones submitted by tasks, has finished
+	void wait()
+	{
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		done.wait(lock, [this] { return pending.load() == 0; });
+	}
+
+private:
+	struct TaskQueue {
+		std::mutex mutex;
+		std::deque<std::function<void()>> tasks;
+	};
+
+	bool takeTask(const unsigned index, std::function<void()> & task)
+	{
+		{
+			TaskQueue & own = *queues[index];
+			std::lock_guard<std::mutex> lock(own.mutex);
+			if (!own.tasks.empty()) {
+				task = std::move(own.tasks.back());
+				own.tasks.pop_back();
+				return true;
+			}
+		}
+		for (std::size_t i = 1; i < queues.size(); ++i) {
+			TaskQueue & victim = *queues[(index + i) % queues.size()];
+			std::lock_guard<std::mutex> lock(victim.mutex);
+			if (!victim.tasks.empty()) {
+				task = std::move(victim.tasks.front());
+				victim.tasks.pop_front();
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void workerLoop(const unsigned index)
+	{
+		currentPool = this;
+		currentWorker = index;
+
+		for (;;) {
+			{
+				std::unique_lock<std::mutex> lock(sleepMutex);
+				wake.wait(lock, [this] { return stopping || queued > 0; });
+				if (queued == 0) {
+					return; // stopping and nothing left to do
+				}
+				--queued;
+			}
+
+			// a queued task exists somewhere, keep looking until it is found
+			std::function<void()> task;
+			while (!takeTask(index, task)) {
+				std::this_thread::yield();
+			}
+			task();
+
+			if (pending.fetch_sub(1) == 1) {
+				std::lock_guard<std::mutex> lock(sleepMutex);
+				done.notify_all();
+			}
+		}
+	}
+
+	std::vector<std::unique_ptr<TaskQueue>> queues;
+	std::vector<std::thread> threads;
+	std::atomic<std::size_t> nextQueue{ 0 };
+	std::atomic<std::size_t> pending{ 0 }; // submitted but not finished
+	std::size_t queued = 0; // submitted but not taken by a worker, guarded by sleepMutex
+	bool stopping = false;
+	std::mutex sleepMutex;
+	std::condition_variable wake;
+	std::condition_variable done;
+
+	static inline thread_local TaskPool * currentPool = nullptr;
+	static inline thread_local unsigned currentWorker = 0;
+};
+
+template <typename MazeType>
+Node placeXX(MazeType & maze, const unsigned entrySelection)
+{
+	if (entrySelection < maze.width) {
+		// entry on top
+		const unsigned entry = entrySelection;
+		maze.setHorizontalWall(0, entry, false);
+		return Node(0, entry);
+	}
+	else if (entrySelection - maze.width < maze.height) {
+		// entry on right
+		const unsigned entry = entrySelection - maze.width;
+		maze.setVerticalWall(entry, maze.width, false);
+		return Node(entry, maze.width - 1);
+	}
+	else if (entrySelection - maze.width - maze.height < maze.width) {
+		// entry on bottom
+		const unsigned entry = entrySelection - maze.width - maze.height;
+		maze.setHorizontalWall(maze.height, maze.width - 1 - entry, false);
+		return Node(maze.height - 1, maze.width - 1 - entry);
+	}
+	else if (entrySelection - maze.width - maze.height - maze.width < maze.height) {
+		// entry on left
+		const unsigned entry = entrySelection - maze.width - maze.height - maze.width;
+		maze.setVerticalWall(maze.height - 1 - entry, 0, false);
+		return Node(maze.height - 1 - entry, 0);
+	}
+	throw std::out_of_range("border selection outside of the maze");
+}
+
+// the border cell behind a placeXX selection, without opening its wall
+template <typename MazeType>
+Node edgeCell(const MazeType & maze, const unsigned selection)
+{
+	if (selection < maze.width) {
+		return Node(0, selection);
+	}
+	else if (selection - maze.width < maze.height) {
+		return Node(selection - maze.width, maze.width - 1);
+	}
+	else if (selection - maze.width - maze.height < maze.width) {
+		return Node(maze.height - 1, maze.width - 1 - (selection - maze.width - maze.height));
+	}
+	else {
+		return Node(maze.height - 1 - (selection - maze.width - maze.height - maze.width), 0);
+	}
+}
+
+// a placeXX selection that opens the outer wall of a border cell
+template <typename MazeType>
+unsigned edgeSelection(const MazeType & maze, const Node & node)
+{
+	if (node.row == 0) {
+		return node.col;
+	}
+	else if (node.col == maze.width - 1) {
+		return maze.width + node.row;
+	}
+	else if (node.row == maze.height - 1) {
+		return maze.width + maze.height + maze.width - 1 - node.col;
+	}
+	else {
+		return maze.width + maze.height + maze.width + maze.height - 1 - node.row;
+	}
+}
+
+// Random opens a random entry and the border cell farthest from it as exit.
+// Longest opens the two border cells farthest apart. When the passages form a tree, as in
+// generateStreaming mazes, one pass over the tree finds them. generateArea mazes have loops,
+// there it searches from every border cell, O(border cells x cells), which is about a hundred
+// small searches at the batch sizes.
+enum class Placement { Random, Longest };
+
+// Border selections of entry and exit. farthestAtEdge(selection, distance) searches from that
+// border cell, returns the selection of the first farthest border cell and sets distance to it.
+template <typename MazeType, typename Engine, typename FarthestAtEdge>
+void selectEntryExit(const MazeType & maze, Engine & rng, const Placement placement, FarthestAtEdge farthestAtEdge, unsigned & entrySelection, unsigned & exitSelection)
+{
+	const unsigned entryOptions = maze.width * 2 + maze.height * 2;
+	unsigned distance = 0;
+
+	if (placement == Placement::Random) {
+		entrySelection = randomIndex(rng, entryOptions);
+		exitSelection = farthestAtEdge(entrySelection, distance);
+		return;
+	}
+
+	// the tree search allocates anyway, one instantiation for every maze type is enough
+	EdgePath path;
+	if (findLongestEdgePath(MazeView(maze), path)) {
+		entrySelection = edgeSelection(maze, path.first);
+		exitSelection = edgeSelection(maze, path.second);
+	}
+	else {
+		// every border cell once, corners have two selections
+		unsigned longest = 0;
+		entrySelection = 0;
+		exitSelection = 0;
+		for (unsigned selection = 0; selection < entryOptions; ++selection) {
+			if (edgeSelection(maze, edgeCell(maze, selection)) != selection) {
+				continue;
+			}
+			const unsigned farthest = farthestAtEdge(selection, distance);
+			if (distance > longest) {
+				longest = distance;
+				entrySelection = selection;
+				exitSelection = farthest;
+			}
+		}
+	}
+	if (exitSelection == entrySelection) {
+		exitSelection = (entrySelection + 1) % entryOptions; // a single cell
+	}
+}
+
+template <typename MazeType, typename Engine, typename Map>
+void placeEntryExit(MazeType & maze, Engine & rng, BfsWorkspace & workspace, Map & map, const Placement placement)
+{
+	MAZE_PHASE(PlaceEntryExit);
+	unsigned entrySelection;
+	unsigned exitSelection;
+	selectEntryExit(maze, rng, placement, [&](const unsigned selection, unsigned & distance) {
+		workspace.run(maze, edgeCell(maze, selection), map);
+		const unsigned farthest = searchMaximumsAtEdge(maze, map)[0];
+		const Node cell = edgeCell(maze, farthest);
+		distance = unsigned(map[cell.row][cell.col]);
+		return farthest;
+	}, entrySelection, exitSelection);
+
+	maze.entryNode = placeXX(maze, entrySelection);
+	maze.exitNode = placeXX(maze, exitSelection);
+
+	// one multi-source pass gives the minimum of the entry and exit distance maps
+	const Node sources[] = { maze.entryNode, maze.exitNode };
+	workspace.run(maze, std::begin(sources), std::end(sources), map);
+}
+
+// Same entry, exit and distances as the queue search, with the searches done layer by layer
+// by the bitboard solver. The solver only reads inner walls, so opening the entry and exit
+// does not need a reload.
+template <typename Engine>
+void placeEntryExit(Maze & maze, Engine & rng, BitboardSolver & solver, const Placement placement = Placement::Random)
+{
+	MAZE_PHASE(PlaceEntryExit);
+	solver.load(maze);
+
+	unsigned entrySelection;
+	unsigned exitSelection;
+	selectEntryExit(maze, rng, placement, [&](const unsigned selection, unsigned & distance) {
+		solver.solve(edgeCell(maze, selection));
+		distance = solver.edgeEccentricity();
+		return solver.maximumsAtEdge()[0];
+	}, entrySelection, exitSelection);
+
+	maze.entryNode = placeXX(maze, entrySelection);
+	maze.exitNode = placeXX(maze, exitSelection);
+
+	const Node sources[] = { maze.entryNode, maze.exitNode };
+	solver.solve(std::begin(sources), std::end(sources), &maze.visualizedDMap);
+}
+
+template <typename Engine>
+void placeEntryExit(Maze & maze, Engine & rng, BfsWorkspace & workspace, const Placement placement = Placement::Random)
+{
+	if (fitsCompactDistances(maze)) {
+		placeEntryExit(maze, rng, workspace, workspace.compactMap, placement);
+		maze.visualizedDMap.assign(workspace.compactMap);
+	}
+	else {
+		placeEntryExit(maze, rng, workspace, maze.visualizedDMap, placement);
+	}
+}
+
+template <unsigned MaxWidth, unsigned MaxHeight, typename Engine>
+void placeEntryExit(FixedMaze<MaxWidth, MaxHeight> & maze, Engine & rng, BfsWorkspace & workspace, const Placement placement = Placement::Random)
+{
+	placeEntryExit(maze, rng, workspace, maze.visualizedDMap, placement);
+}
+
+// same as placeEntryExit, with the searches done tile by tile into maze.visualizedDMap
+template <typename Engine>
+void placeEntryExit(TiledMaze & maze, Engine & rng)
+{
+	MAZE_PHASE(PlaceEntryExit);
+	const unsigned entryOptions = maze.width * 2 + maze.height * 2;
+	const unsigned entrySelection = randomIndex(rng, entryOptions);
+
+	maze.entryNode = placeXX(maze, entrySelection);
+
+	generateDistanceMap(maze, maze.entryNode, maze.visualizedDMap);
+
+	std::vector<unsigned> maximumsAtEdge = searchMaximumsAtEdge(maze, maze.visualizedDMap);
+	maze.exitNode = placeXX(maze, maximumsAtEdge[0]);
+
+	const Node sources[] = { maze.entryNode, maze.exitNode };
+	runTiledBfs(maze, std::begin(sources), std::end(sources), maze.visualizedDMap);
+}
+
+// Random engine adaptor that pulls raw numbers from the engine in blocks.
+// Results are consumed in engine order, so distributions see the same sequence as with the
+// engine itself. The engine is read ahead by up to one block.
+template <typename Engine>
+class BufferedRandom {
+public:
+	using result_type = typename Engine::result_type;
+
+	explicit BufferedRandom(Engine & engine) : engine(engine), position(blockSize) {}
+
+	static constexpr result_type min() { return Engine::min(); }
+	static constexpr result_type max() { return Engine::max(); }
+
+	result_type operator()()
+	{
+		if (position == blockSize) {
+			for (result_type & value : block) {
+				value = engine();
+			}
+			position = 0;
+		}
+		return block[position++];
+	}
+
+	// uniform integer from [first, last]
+	unsigned uniform(const unsigned first, const unsigned last)
+	{
+		return distribution(*this, std::uniform_int_distribution<unsigned>::param_type(first, last));
+	}
+
+private:
+	static const unsigned blockSize = 128;
+
+	Engine & engine;
+	result_type block[blockSize];
+	unsigned position;
+	std::uniform_int_distribution<unsigned> distribution;
+};
+
+using GeneratorRandom = BufferedRandom<std::mt19937>;
+
+// Generator random policy for the fast engines: bounded integers straight from the engine
+// with boundedRandom, no buffering and no distribution object.
+template <typename Engine>
+class FastRandom {
+public:
+	explicit FastRandom(Engine & engine) : engine(engine) {}
+
+	// uniform integer from [first, last]
+	unsigned uniform(const unsigned first, const unsigned last)
+	{
+		return first + boundedRandom(engine, last - first + 1);
+	}
+
+private:
+	Engine & engine;
+};
+
+// Random policy the generators use for an engine. std::mt19937 stays with BufferedRandom
+// and its std distribution, so a seed gives the same maze as before.
+template <typename Engine>
+struct RandomPolicy {
+	using type = FastRandom<Engine>;
+};
+
+template <>
+struct RandomPolicy<std::mt19937> {
+	using type = GeneratorRandom;
+};
+
+struct Area {
+	unsigned leftWall;
+	unsigned topWall;
+	unsigned rightWall;
+	unsigned bottomWall;
+};
+
+struct WallSegment {
+	unsigned firstElement;
+	unsigned lastElement;
+};
+
+// Pending work of the iterative generator. The stacks only hold the not yet visited
+// siblings along the current path, so they stay proportional to the split depth
+// (at most width + height entries) and are reused between calls.
+struct GeneratorStacks {
+	std::vector<Area> areas;
+	std::vector<WallSegment> segments;
+};
+
+struct ParallelGeneration;
+
+// parallel generation only runs on in-memory mazes, other mazes are always opened directly
+inline void openDoor(Maze & maze, const Orientation orientation, const unsigned line, const unsigned element, const bool sharedWalls)
+{
+	if (sharedWalls) {
+		maze.openWallShared(orientation, line, element);
+	}
+	else {
+		maze.openWall(orientation, line, element);
+	}
+}
+
+template <typename MazeType>
+void openDoor(MazeType & maze, const Orientation orientation, const unsigned line, const unsigned element, bool)
+{
+	maze.openWall(orientation, line, element);
+}
+
+template <typename MazeType, typename Random>
+void openTheWall(MazeType & maze, Random & random, std::vector<WallSegment> & pending, const Orientation orientation, const unsigned line, const unsigned firstElement, const unsigned lastElement, const unsigned fullLength, const bool sharedWalls)
+{
+	pending.clear();
+	pending.push_back({ firstElement, lastElement });
+
+	while (!pending.empty()) {
+		const WallSegment segment = pending.back();
+		pending.pop_back();
+
+		const unsigned isThereADoor = random.uniform(1, fullLength) <= (segment.lastElement - segment.firstElement + 1);
+
+		if (!isThereADoor)
+			continue;
+
+		const unsigned doorAt = random.uniform(segment.firstElement, segment.lastElement);
+
+		openDoor(maze, orientation, line, doorAt, sharedWalls);
+
+		// the part before the door is handled first, so it is pushed last
+		if (segment.lastElement - doorAt >= 2) {
+			pending.push_back({ doorAt + 2, segment.lastElement });
+		}
+		if (doorAt - segment.firstElement >= 2) {
+			pending.push_back({ segment.firstElement, doorAt - 2 });
+		}
+	}
+}
+
+inline void spawnArea(ParallelGeneration & parallel, const Area & area);
+inline bool isParallelArea(const ParallelGeneration & parallel, const Area & area);
+
+// Recursive division with an explicit stack, areas are split in the same order as a
+// depth first recursion would do. parallel is null for a plain single threaded generation.
+template <typename MazeType, typename Random>
+void generateArea(MazeType & maze, Random & random, GeneratorStacks & stacks, const Area & fullArea, ParallelGeneration * parallel = nullptr)
+{
+	std::vector<Area> & pending = stacks.areas;
+	pending.clear();
+	pending.push_back(fullArea);
+
+	const auto subArea = [&](const Area & area) {
+		if (parallel && isParallelArea(*parallel, area)) {
+			spawnArea(*parallel, area);
+		}
+		else {
+			pending.push_back(area);
+		}
+	};
+
+	while (!pending.empty()) {
+		const Area area = pending.back();
+		pending.pop_back();
+
+		const unsigned width = area.rightWall - area.leftWall;
+		const unsigned height = area.bottomWall - area.topWall;
+
+		if (width == 1 && height == 1) {
+			continue; // cannot split further
+		}
+
+		const unsigned verticalSplitOptions = width - 1;
+		const unsigned horizontalSplitOptions = height - 1;
+		const unsigned totalSplitOptions = verticalSplitOptions + horizontalSplitOptions;
+		const unsigned splitSelection = random.uniform(0, totalSplitOptions - 1);
+
+		const bool verticalSplit = splitSelection < verticalSplitOptions;
+
+		// the second half is pushed first, so the first half is generated next
+		if (verticalSplit) {
+			const unsigned splitAt = area.leftWall + splitSelection + 1;
+
+			openTheWall(maze, random, stacks.segments, Orientation::Vertical, splitAt, area.topWall, area.bottomWall - 1, height, parallel != nullptr);
+
+			subArea({ splitAt, area.topWall, area.rightWall, area.bottomWall });
+			subArea({ area.leftWall, area.topWall, splitAt, area.bottomWall });
+		}
+		else { // horizontal split
+			const unsigned splitAt = area.topWall + splitSelection - verticalSplitOptions + 1;
+
+			openTheWall(maze, random, stacks.segments, Orientation::Horizontal, splitAt, area.leftWall, area.rightWall - 1, width, parallel != nullptr);
+
+			subArea({ area.leftWall, splitAt, area.rightWall, area.bottomWall });
+			subArea({ area.leftWall, area.topWall, area.rightWall, splitAt });
+		}
+		MAZE_PEAK(peakGeneratorDepth, pending.size());
+	}
+}
+
+template <typename MazeType, typename Engine>
+void generateArea(MazeType & maze, Engine & rng, const unsigned leftWall, const unsigned topWall, const unsigned rightWall, const unsigned bottomWall)
+{
+	MAZE_PHASE(GenerateArea);
+	typename RandomPolicy<Engine>::type random(rng);
+	GeneratorStacks stacks;
+	generateArea(maze, random, stacks, { leftWall, topWall, rightWall, bottomWall });
+}
+
+// Shared state of one parallel generation.
+// Areas above the cutoff become pool tasks and draw from their own random stream, seeded
+// from the generation seed and the area coordinates. Which areas get a stream only depends
+// on the cutoff, so a seed gives the same maze for any number of threads.
+struct ParallelGeneration {
+	ParallelGeneration(Maze & maze, TaskPool & pool, const std::uint64_t seed, const std::uint64_t cutoff)
+		: maze(maze), pool(pool), seed(seed), cutoff(cutoff)
+	{
+
+	}
+
+	Maze & maze;
+	TaskPool & pool;
+	const std::uint64_t seed;
+	const std::uint64_t cutoff; // areas with more cells than this are generated as separate tasks
+};
+
+inline bool isParallelArea(const ParallelGeneration & parallel, const Area & area)
+{
+	return std::uint64_t(area.rightWall - area.leftWall) * (area.bottomWall - area.topWall) > parallel.cutoff;
+}
+
+inline std::mt19937 areaRandom(const std::uint64_t seed, const Area & area)
+{
+	std::uint64_t state = seed;
+	std::uint64_t mixed = splitMix64(state);
+	for (const unsigned coordinate : { area.leftWall, area.topWall, area.rightWall, area.bottomWall }) {
+		state ^= mixed + coordinate;
+		mixed = splitMix64(state);
+	}
+	return seededRandom(mixed);
+}
+
+inline void spawnArea(ParallelGeneration & parallel, const Area & area)
+{
+	parallel.pool.submit([&parallel, area] {
+		thread_local GeneratorStacks stacks;
+		std::mt19937 rng = areaRandom(parallel.seed, area);
+		GeneratorRandom random(rng);
+		generateArea(parallel.maze, random, stacks, area, &parallel);
+	});
+}
+
+// generates the whole maze on the pool, the result only depends on seed and cutoff
+inline void generateAreaParallel(Maze & maze, TaskPool & pool, const std::uint64_t seed, const std::uint64_t cutoff = 64 * 1024)
+{
+	MAZE_PHASE(GenerateArea);
+	ParallelGeneration parallel(maze, pool, seed, cutoff);
+	spawnArea(parallel, { 0, 0, maze.width, maze.height });
+	pool.wait();
+}
+
+template <typename MazeType>
+void printCell(const MazeType & maze, const unsigned row, const unsigned col)
+{
+	const bool openToTop = !maze.hasHorizontalWall(row, col); // bit 0
+	const bool openToBottom = !maze.hasHorizontalWall(row+1, col); // bit 1
+	const bool openToLeft = !maze.hasVerticalWall(row, col); // bit 2
+	const bool openToRight = !maze.hasVerticalWall(row, col+1); // bit 3
+	
+	const unsigned value = openToTop + openToBottom * 2 + openToLeft * 4 + openToRight * 8;
+
+	static const char elements[] = { 'X', 'V', 'A', char(186), '>', char(188), char(187), char(185), '<', char(200), char(201), char(204), char(205), char(202), char(203), char(206) };
+
+	std::cout << elements[value];
+}
+
+template <typename MazeType>
+void printMaze(const MazeType & maze)
+{
+	for (unsigned row = 0; row < maze.height; ++row) {
+		for (unsigned col = 0; col < maze.width; ++col) {
+			printCell(maze, row, col);
+		}
+		std::cout << std::endl;
+	}
+}
+
+template <typename MazeType>
+void printMaze2(const MazeType & maze, std::ostream & out = std::cout)
+{
+	MAZE_PHASE(PrintText);
+	MAZE_COUNT(bytesWritten, (std::uint64_t(maze.width) * 2 + 2) * (std::uint64_t(maze.height) * 2 + 1));
+	for (unsigned row = 0; row < maze.height * 2 + 1; ++row) {
+		for (unsigned col = 0; col < maze.width * 2 + 1; ++col) {
+			if (row % 2 == 0) {
+				if (col % 2 == 0) {
+					out << char(219);
+				}
+				else {
+					out << (maze.hasHorizontalWall(row / 2, col / 2) ? char(219) : ' ');
+				}
+			}
+			else {
+				if (col % 2 == 0) {
+					out << (maze.hasVerticalWall(row / 2, col / 2) ? char(219) : ' ');
+				}
+				else {
+					out << ' ';
+				}
+			}
+		}
+		out << '\n';
+	}
+}
+
+// printMaze2 into a file
+template <typename MazeType>
+void printMazeText(const MazeType & maze, const std::string & fileName)
+{
+	std::ofstream f(fileName, std::ios::binary);
+	printMaze2(maze, f);
+	f.flush();
+	if (!f) {
+		throw std::runtime_error("cannot write " + fileName);
+	}
+}
+
+// Buffered, locale independent text output for large vector files.
+// Nothing is flushed before the buffer is full, numbers are formatted with std::to_chars.
+// Write errors throw std::runtime_error; the destructor cannot throw, so writers call flush
+// at the end to see errors of the last block.
+class BufferedWriter {
+public:
+	explicit BufferedWriter(const std::string & fileName) : fileName(fileName), f(fileName, std::ios::binary), used(0), written(0)
+	{
+		checkStream();
+		buffer.resize(bufferSize);
+	}
+
+	~BufferedWriter()
+	{
+		try {
+			flush();
+		}
+		catch (const std::exception &) {
+		}
+	}
+
+	BufferedWriter & operator<<(const char * text)
+	{
+		return write(text, std::strlen(text));
+	}
+
+	BufferedWriter & operator<<(const char c)
+	{
+		return write(&c, 1);
+	}
+
+	BufferedWriter & operator<<(const std::uint64_t value)
+	{
+		char digits[24];
+		const std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), value);
+		return write(digits, result.ptr - digits);
+	}
+
+	BufferedWriter & operator<<(const unsigned value)
+	{
+		return *this << std::uint64_t(value);
+	}
+
+	BufferedWriter & operator<<(const float value)
+	{
+		return *this << double(value);
+	}
+
+	// fixed point with at most three decimals, trailing zeros dropped
+	BufferedWriter & operator<<(const double value)
+	{
+		const double scaled = value * 1000;
+		const std::int64_t thousandths = std::int64_t(scaled < 0 ? scaled - 0.5 : scaled + 0.5);
+		const std::uint64_t magnitude = thousandths < 0 ? std::uint64_t(-thousandths) : std::uint64_t(thousandths);
+		if (thousandths < 0) {
+			*this << '-';
+		}
+		*this << magnitude / 1000;
+
+		unsigned fraction = unsigned(magnitude % 1000);
+		if (fraction != 0) {
+			char digits[4] = { '.', char('0' + fraction / 100), char('0' + fraction / 10 % 10), char('0' + fraction % 10) };
+			std::size_t length = 4;
+			while (digits[length - 1] == '0') {
+				--length;
+			}
+			write(digits, length);
+		}
+		return *this;
+	}
+
+	void flush()
+	{
+		f.write(buffer.data(), used);
+		written += used;
+		MAZE_COUNT(bytesWritten, used);
+		used = 0;
+		f.flush();
+		checkStream();
+	}
+
+	// number of bytes written so far, including the buffered ones
+	std::uint64_t position() const
+	{
+		return written + used;
+	}
+
+private:
+	BufferedWriter & write(const char * data, const std::size_t size)
+	{
+		if (used + size > buffer.size()) {
+			f.write(buffer.data(), used);
+			written += used;
+			MAZE_COUNT(bytesWritten, used);
+			used = 0;
+			if (size > buffer.size()) {
+				f.write(data, size);
+				written += size;
+				MAZE_COUNT(bytesWritten, size);
+				checkStream();
+				return *this;
+			}
+			checkStream();
+		}
+		std::memcpy(buffer.data() + used, data, size);
+		used += size;
+		return *this;
+	}
+
+	void checkStream() const
+	{
+		if (!f) {
+			throw std::runtime_error("cannot write " + fileName);
+		}
+	}
+
+	static const std::size_t bufferSize = 1 << 20;
+
+	const std::string fileName;
+	std::ofstream f;
+	std::vector<char> buffer;
+	std::size_t used;
+	std::uint64_t written;
+};
+
+// Placement of a maze on an A4 portrait page, all values in millimetres.
+struct PageLayout {
+	PageLayout(const unsigned width, const unsigned height)
+	{
+		const float fitStepW = (pageWidth - 2 * margin) / width;
+		const float fitStepH = (pageHeight - 2 * margin) / height;
+		const float fitStep = std::min(fitStepH, fitStepW);
+		step = std::min(fitStep, maxStep);
+
+		const float mazeWidth = step * width;
+		const float mazeHeight = step * height;
+
+		left = (pageWidth - mazeWidth) / 2;
+		top = (pageHeight - mazeHeight) / 2;
+	}
+
+	static constexpr float pageWidth = 210;
+	static constexpr float pageHeight = 297;
+	static constexpr float margin = 20;
+	static constexpr float maxStep = 10;
+
+	float step;
+	float left;
+	float top;
+};
+
+// first column at or after from whose bit equals value, cols when there is none
+inline unsigned findBit(const std::uint64_t * words, const unsigned cols, const unsigned from, const bool value)
+{
+	unsigned i = from / 64;
+	std::uint64_t word = (value ? words[i] : ~words[i]) & (~std::uint64_t(0) << (from % 64));
+	while (word == 0) {
+		if (++i * 64 >= cols) {
+			return cols;
+		}
+		word = value ? words[i] : ~words[i];
+	}
+	return std::min(cols, i * 64 + countTrailingZeros(word));
+}
+
+// calls emit(firstCol, length) for every run of set bits in a packed row
+template <typename Emit>
+void forEachRun(const std::uint64_t * words, const unsigned cols, Emit emit)
+{
+	unsigned col = 0;
+	while (col < cols) {
+		col = findBit(words, cols, col, true);
+		if (col == cols) {
+			break;
+		}
+		const unsigned end = findBit(words, cols, col, false);
+		emit(col, end - col);
+		col = end;
+	}
+}
+
+// Follows runs of set bits down the columns of consecutive packed rows.
+// Only columns that change between two rows are visited.
+class ColumnRuns {
+public:
+	explicit ColumnRuns(const unsigned cols) : previous((cols + 63) / 64, 0), runStart(cols, 0) {}
+
+	// emit(col, firstRow, length) is called for every run that ends above row
+	template <typename Emit>
+	void nextRow(const std::uint64_t * words, const unsigned row, Emit emit)
+	{
+		for (unsigned i = 0; i < previous.size(); ++i) {
+			for (std::uint64_t changed = words[i] ^ previous[i]; changed != 0; changed &= changed - 1) {
+				const unsigned col = i * 64 + countTrailingZeros(changed);
+				if ((words[i] >> (col % 64)) & 1) {
+					runStart[col] = row;
+				}
+				else {
+					emit(col, runStart[col], row - runStart[col]);
+				}
+			}
+			previous[i] = words[i];
+		}
+	}
+
+	// closes the runs that are still open after the last row
+	template <typename Emit>
+	void finish(const unsigned rowEnd, Emit emit)
+	{
+		const std::vector<std::uint64_t> empty(previous.size(), 0);
+		nextRow(empty.data(), rowEnd, emit);
+	}
+
+private:
+	std::vector<std::uint64_t> previous;
+	std::vector<unsigned> runStart;
+};
+
+enum class DistanceLabels { None, PerCell, PerRow };
+
+template <typename MazeType>
+void printMazeSVG(const MazeType & maze, const std::string & svgName, const DistanceLabels labels)
+{
+	MAZE_PHASE(PrintSvg);
+	BufferedWriter f(svgName);
+
+	f << "<?xml version='1.0' standalone='no'?>\n";
+	f << "<svg width='210mm' height='297mm' version='1.1' xmlns='http://www.w3.org/2000/svg' viewBox='0 0 210 297'>\n";
+
+	f << "<rect x='0' y='0' width='210' height='297' fill='white'/>\n";
+
+	f << "<g stroke='black' stroke-linecap='round' stroke-width='0.5' >\n";
+
+	const PageLayout layout(maze.width, maze.height);
+	const float step = layout.step;
+	const float left = layout.left;
+	const float top = layout.top;
+
+	// every straight run of walls becomes a single subpath
+	f << "<path fill='none' d='";
+	for (unsigned row = 0; row < maze.height + 1; ++row) {
+		forEachRun(maze.horizontalWalls.rowWords(row), maze.width, [&](const unsigned col, const unsigned length) {
+			f << 'M' << (left + step * col) << ' ' << (top + step * row) << 'h' << (step * length);
+		});
+	}
+	const auto verticalRun = [&](const unsigned col, const unsigned row, const unsigned length) {
+		f << 'M' << (left + step * col) << ' ' << (top + step * row) << 'v' << (step * length);
+	};
+	ColumnRuns columns(maze.width + 1);
+	for (unsigned row = 0; row < maze.height; ++row) {
+		columns.nextRow(maze.verticalWalls.rowWords(row), row, verticalRun);
+	}
+	columns.finish(maze.height, verticalRun);
+	f << "' />\n";
+
+	if (labels == DistanceLabels::PerCell)
+	{
+		for (unsigned row = 0; row < maze.height; ++row) {
+			for (unsigned col = 0; col < maze.width; ++col) {
+				if (maze.visualizedDMap[row][col] == DistanceMap::unreachable()) {
+					continue;
+				}
+				const float x = left + step * col;
+				const float y = top + step * row;
+				f << "<text x='" << (x + step / 4) << "' y='" << (y + step / 2) << "' style='fill: black; font: 5px sans-serif '>\n";
+				f << maze.visualizedDMap[row][col] << '\n';
+				f << "</text>\n";
+			}
+		}
+	}
+	else if (labels == DistanceLabels::PerRow)
+	{
+		for (unsigned row = 0; row < maze.height; ++row) {
+			f << "<text y='" << (top + step * row + step / 2) << "' style='fill: black; font: 5px sans-serif '>";
+			for (unsigned col = 0; col < maze.width; ++col) {
+				if (maze.visualizedDMap[row][col] != DistanceMap::unreachable()) {
+					f << "<tspan x='" << (left + step * col + step / 4) << "'>" << maze.visualizedDMap[row][col] << "</tspan>";
+				}
+			}
+			f << "</text>\n";
+		}
+	}
+
+
+	f << "</g>\n";
+	f << "</svg>\n";
+	f.flush();
+}
+
+// Multi-page vector PDF, one A4 page per maze, walls drawn with the SVG page layout.
+// Content streams are written uncompressed; their length is stored in a separate object
+// behind the stream so pages can be written straight to the file.
+class PdfWriter {
+public:
+	explicit PdfWriter(const std::string & pdfName) : f(pdfName), finished(false)
+	{
+		f << "%PDF-1.4\n%\xE2\xE3\xCF\xD3\n";
+		// 1 is the catalog and 2 the page tree, both are written by finish
+		offsets.resize(2, 0);
+	}
+
+	// call finish to see write errors, the destructor ignores them
+	~PdfWriter()
+	{
+		try {
+			finish();
+		}
+		catch (const std::exception &) {
+		}
+	}
+
+	template <typename MazeType>
+	void addPage(const MazeType & maze)
+	{
+		MAZE_PHASE(PrintPdf);
+		const unsigned pageObject = unsigned(offsets.size()) + 1;
+		const unsigned contentObject = pageObject + 1;
+		const unsigned lengthObject = pageObject + 2;
+		pages.push_back(pageObject);
+
+		beginObject(pageObject);
+		f << "<< /Type /Page /Parent 2 0 R /MediaBox [0 0 595.276 841.89] /Resources << >> /Contents " << contentObject << " 0 R >>\n";
+		endObject();
+
+		beginObject(contentObject);
+		f << "<< /Length " << lengthObject << " 0 R >>\nstream\n";
+		const std::uint64_t streamStart = f.position();
+
+		// millimetres with the origin in the top left corner, like the SVG viewBox
+		f << "2.834646 0 0 -2.834646 0 841.89 cm\n0.5 w 1 J 1 j\n";
+
+		const PageLayout layout(maze.width, maze.height);
+		const float step = layout.step;
+		const float left = layout.left;
+		const float top = layout.top;
+
+		for (unsigned row = 0; row < maze.height + 1; ++row) {
+			forEachRun(maze.horizontalWalls.rowWords(row), maze.width, [&](const unsigned col, const unsigned length) {
+				const float y = top + step * row;
+				f << (left + step * col) << ' ' << y << " m " << (left + step * (col + length)) << ' ' << y << " l\n";
+			});
+		}
+		const auto verticalRun = [&](const unsigned col, const unsigned row, const unsigned length) {
+			const float x = left + step * col;
+			f << x << ' ' << (top + step * row) << " m " << x << ' ' << (top + step * (row + length)) << " l\n";
+		};
+		ColumnRuns columns(maze.width + 1);
+		for (unsigned row = 0; row < maze.height; ++row) {
+			columns.nextRow(maze.verticalWalls.rowWords(row), row, verticalRun);
+		}
+		columns.finish(maze.height, verticalRun);
+		f << "S\n";
+
+		const std::uint64_t streamLength = f.position() - streamStart;
+		f << "endstream\n";
+		endObject();
+
+		beginObject(lengthObject);
+		f << streamLength << '\n';
+		endObject();
+	}
+
+	// writes page tree, catalog and cross reference table, called by the destructor as well
+	void finish()
+	{
+		if (finished) {
+			return;
+		}
+		finished = true;
+
+		beginObject(2);
+		f << "<< /Type /Pages /Count " << unsigned(pages.size()) << " /Kids [";
+		for (const unsigned page : pages) {
+			f << ' ' << page << " 0 R";
+		}
+		f << " ] >>\n";
+		endObject();
+
+		beginObject(1);
+		f << "<< /Type /Catalog /Pages 2 0 R >>\n";
+		endObject();
+
+		const std::uint64_t xrefOffset = f.position();
+		f << "xref\n0 " << unsigned(offsets.size() + 1) << "\n0000000000 65535 f \n";
+		for (const std::uint64_t offset : offsets) {
+			char entry[32];
+			std::snprintf(entry, sizeof(entry), "%010llu 00000 n \n", static_cast<unsigned long long>(offset));
+			f << entry;
+		}
+		f << "trailer\n<< /Size " << unsigned(offsets.size() + 1) << " /Root 1 0 R >>\nstartxref\n" << xrefOffset << "\n%%EOF\n";
+		f.flush();
+	}
+
+private:
+	void beginObject(const unsigned object)
+	{
+		if (offsets.size() < object) {
+			offsets.resize(object, 0);
+		}
+		offsets[object - 1] = f.position();
+		f << object << " 0 obj\n";
+	}
+
+	void endObject()
+	{
+		f << "endobj\n";
+	}
+
+	BufferedWriter f;
+	std::vector<std::uint64_t> offsets; // file offset of every object, object number - 1
+	std::vector<unsigned> pages;
+	bool finished;
+};
+
+template <typename MazeType>
+void printMazePDF(const MazeType & maze, const std::string & pdfName)
+{
+	PdfWriter pdf(pdfName);
+	pdf.addPage(maze);
+	pdf.finish();
+}
+
+// Walls of one row produced by the streaming generator.
+struct MazeRow {
+	explicit MazeRow(const unsigned width) : leftWalls(1, width + 1, true), bottomWalls(1, width, true) {}
+
+	// wall on the left side of the cell, col can be width for the right border
+	bool hasLeftWall(const unsigned col) const { return leftWalls.get(0, col); }
+	bool hasBottomWall(const unsigned col) const { return bottomWalls.get(0, col); }
+
+	BitGrid leftWalls;
+	BitGrid bottomWalls;
+};
+
+// Receives a streamed maze row by row. The top border is closed except above entryCol,
+// the exit is an opening in the bottom wall of the last row.
+class RowSink {
+public:
+	virtual ~RowSink() {}
+	virtual void begin(const unsigned width, const unsigned height, const unsigned entryCol, const unsigned exitCol) = 0;
+	virtual void row(const unsigned row, const MazeRow & walls) = 0;
+	virtual void end() = 0;
+};
+
+// Row by row generation with Eller's algorithm.
+// Only the set membership of the current row is kept, so memory is O(width) whatever the
+// height is, and every row is handed to the sink as soon as it is final.
+template <typename Engine>
+void generateStreaming(const unsigned width, const unsigned height, Engine & rng, RowSink & sink)
+{
+	const unsigned none = std::numeric_limits<unsigned>::max();
+
+	typename RandomPolicy<Engine>::type random(rng);
+	MazeRow walls(width);
+
+	// sets are labelled with the root column of the row above, or width + col for new sets
+	std::vector<unsigned> label(width);
+	std::vector<unsigned> labelColumn(2 * width, none);
+	std::vector<unsigned> parent(width); // union-find over the columns of the current row
+	std::vector<unsigned> members(width);
+	std::vector<unsigned> downs(width);
+
+	const auto find = [&](unsigned col) {
+		while (parent[col] != col) {
+			parent[col] = parent[parent[col]];
+			col = parent[col];
+		}
+		return col;
+	};
+
+	for (unsigned col = 0; col < width; ++col) {
+		label[col] = width + col;
+	}
+
+	const unsigned entryCol = random.uniform(0, width - 1);
+	const unsigned exitCol = random.uniform(0, width - 1);
+	sink.begin(width, height, entryCol, exitCol);
+
+	for (unsigned row = 0; row < height; ++row) {
+		const bool lastRow = row == height - 1;
+
+		for (unsigned col = 0; col < width; ++col) {
+			if (labelColumn[label[col]] == none) {
+				labelColumn[label[col]] = col;
+			}
+			parent[col] = labelColumn[label[col]];
+		}
+		for (unsigned col = 0; col < width; ++col) {
+			labelColumn[label[col]] = none;
+		}
+
+		// join neighbours of different sets, the last row has to join everything
+		for (unsigned col = 0; col + 1 < width; ++col) {
+			const unsigned left = find(col);
+			const unsigned right = find(col + 1);
+			const bool join = left != right && (lastRow || random.uniform(0, 1) == 1);
+			walls.leftWalls.set(0, col + 1, !join);
+			if (join) {
+				parent[right] = left;
+			}
+		}
+
+		if (lastRow) {
+			for (unsigned col = 0; col < width; ++col) {
+				walls.bottomWalls.set(0, col, col != exitCol);
+			}
+			sink.row(row, walls);
+			break;
+		}
+
+		// every set has to continue downwards through at least one cell
+		std::fill(members.begin(), members.end(), 0);
+		std::fill(downs.begin(), downs.end(), 0);
+		for (unsigned col = 0; col < width; ++col) {
+			const unsigned root = find(col);
+			members[root]++;
+			const bool down = random.uniform(0, 1) == 1;
+			walls.bottomWalls.set(0, col, !down);
+			downs[root] += down;
+		}
+		for (unsigned col = 0; col < width; ++col) {
+			const unsigned root = find(col);
+			if (downs[root] == 0) {
+				// picks each remaining member with probability 1 / remaining, so one is always picked
+				if (random.uniform(1, members[root]) == 1) {
+					walls.bottomWalls.set(0, col, false);
+					downs[root] = 1;
+				}
+				else {
+					members[root]--;
+				}
+			}
+		}
+
+		sink.row(row, walls);
+
+		for (unsigned col = 0; col < width; ++col) {
+			label[col] = walls.hasBottomWall(col) ? width + col : find(col);
+		}
+	}
+
+	sink.end();
+}
+
+// printMaze2 style block drawing
+class AsciiRowSink : public RowSink {
+public:
+	explicit AsciiRowSink(std::ostream & out) : out(out), width(0) {}
+
+	void begin(const unsigned width, unsigned, const unsigned entryCol, unsigned) override
+	{
+		this->width = width;
+		for (unsigned col = 0; col < width * 2 + 1; ++col) {
+			out << (col % 2 == 0 || col / 2 != entryCol ? char(219) : ' ');
+		}
+		out << '\n';
+	}
+
+	void row(unsigned, const MazeRow & walls) override
+	{
+		for (unsigned col = 0; col < width * 2 + 1; ++col) {
+			out << (col % 2 == 0 && walls.hasLeftWall(col / 2) ? char(219) : ' ');
+		}
+		out << '\n';
+		for (unsigned col = 0; col < width * 2 + 1; ++col) {
+			out << (col % 2 == 0 || walls.hasBottomWall(col / 2) ? char(219) : ' ');
+		}
+		out << '\n';
+	}
+
+	void end() override
+	{
+		out.flush();
+	}
+
+private:
+	std::ostream & out;
+	unsigned width;
+};
+
+// A4 wide strip, the page grows with the height of the maze
+class SvgRowSink : public RowSink {
+public:
+	explicit SvgRowSink(const std::string & svgName) : f(svgName), width(0), step(0), left(0), top(0) {}
+
+	void begin(const unsigned width, const unsigned height, const unsigned entryCol, unsigned) override
+	{
+		this->width = width;
+		columns.reset(new ColumnRuns(width + 1));
+
+		// double precision, coordinates of very long strips do not fit into a float
+		const double w = PageLayout::pageWidth;
+		const double margin = PageLayout::margin;
+		step = std::min((w - 2 * margin) / width, double(PageLayout::maxStep));
+		left = (w - step * width) / 2;
+		top = margin;
+		const double h = 2 * margin + step * height;
+
+		f << "<?xml version='1.0' standalone='no'?>\n";
+		f << "<svg width='210mm' height='" << h << "mm' version='1.1' xmlns='http://www.w3.org/2000/svg' viewBox='0 0 210 " << h << "'>\n";
+		f << "<rect x='0' y='0' width='210' height='" << h << "' fill='white'/>\n";
+		f << "<g stroke='black' stroke-linecap='round' stroke-width='0.5' >\n";
+		f << "<path fill='none' d='";
+
+		if (entryCol > 0) {
+			horizontalRun(0, entryCol, top);
+		}
+		if (entryCol + 1 < width) {
+			horizontalRun(entryCol + 1, width - entryCol - 1, top);
+		}
+	}
+
+	void row(const unsigned row, const MazeRow & walls) override
+	{
+		columns->nextRow(walls.leftWalls.rowWords(0), row, [this](const unsigned col, const unsigned firstRow, const unsigned length) {
+			verticalRun(col, firstRow, length);
+		});
+		forEachRun(walls.bottomWalls.rowWords(0), width, [this, row](const unsigned col, const unsigned length) {
+			horizontalRun(col, length, top + step * (row + 1));
+		});
+		rows = row + 1;
+	}
+
+	void end() override
+	{
+		columns->finish(rows, [this](const unsigned col, const unsigned firstRow, const unsigned length) {
+			verticalRun(col, firstRow, length);
+		});
+		f << "' />\n";
+		f << "</g>\n";
+		f << "</svg>\n";
+		f.flush();
+	}
+
+private:
+	void horizontalRun(const unsigned col, const unsigned length, const double y)
+	{
+		f << 'M' << (left + step * col) << ' ' << y << 'h' << (step * length);
+	}
+
+	void verticalRun(const unsigned col, const unsigned firstRow, const unsigned length)
+	{
+		f << 'M' << (left + step * col) << ' ' << (top + step * firstRow) << 'v' << (step * length);
+	}
+
+	BufferedWriter f;
+	std::unique_ptr<ColumnRuns> columns; // vertical walls continue from row to row
+	unsigned width;
+	unsigned rows = 0;
+	double step;
+	double left;
+	double top;
+};
+
+// Little endian row stream: "MZRS", version, width, height, entry column, exit column as
+// 32 bit values, then for every row the left walls (width + 1 bits) followed by the bottom
+// walls (width bits), each padded to whole bytes, lowest column in the lowest bit.
+class BinaryRowSink : public RowSink {
+public:
+	explicit BinaryRowSink(const std::string & fileName) : fileName(fileName), f(fileName, std::ios::binary) {}
+
+	void begin(const unsigned width, const unsigned height, const unsigned entryCol, const unsigned exitCol) override
+	{
+		f.write("MZRS", 4);
+		for (const std::uint32_t value : { std::uint32_t(1), width, height, entryCol, exitCol }) {
+			writeBytes(value, 4);
+		}
+	}
+
+	void row(unsigned, const MazeRow & walls) override
+	{
+		writeBits(walls.leftWalls);
+		writeBits(walls.bottomWalls);
+	}
+
+	void end() override
+	{
+		f.flush();
+		if (!f) {
+			throw std::runtime_error("cannot write " + fileName);
+		}
+	}
+
+private:
+	void writeBytes(const std::uint64_t value, const unsigned count)
+	{
+		for (unsigned i = 0; i < count; ++i) {
+			f.put(char((value >> (8 * i)) & 0xFF));
+		}
+	}
+
+	void writeBits(const BitGrid & bits)
+	{
+		const unsigned bytes = (bits.cols + 7) / 8;
+		const std::uint64_t * const words = bits.rowWords(0);
+		for (unsigned i = 0; i < bytes; i += 8) {
+			writeBytes(words[i / 8], std::min(8u, bytes - i));
+		}
+	}
+
+	const std::string fileName;
+	std::ofstream f;
+};
+
+template <typename Engine>
+Maze generateMaze(const unsigned width, const unsigned height, Engine & rng, BfsWorkspace & workspace, const Placement placement = Placement::Random)
+{
+	Maze m(width, height);
+	generateArea(m, rng, 0, 0, width, height);
+	placeEntryExit(m, rng, workspace, placement);
+
+	return m;
+}